@@ -12,8 +12,16 @@
 #include <hpx/iostream.hpp>
 #include <hpx/modules/program_options.hpp>
 
+#include "payload_compression.hpp"
+
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <random>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 auto func(std::vector<char> data) {
 	// hpx::util::format_to(
@@ -24,40 +32,236 @@ auto func(std::vector<char> data) {
 
 HPX_PLAIN_ACTION(func, func_action)
 
-int hpx_main() {
-	hpx::util::format_to(hpx::cout, "window,msg_size,i,µs,MB/s\n");
+// same signature as execute_function in bulk_http_hpx.cpp, returns its input
+// like the echo function does
+compressible_bytes
+echo_function(std::uint32_t function_id, compressible_bytes input) {
+	return input;
+}
 
-	const auto remote = hpx::find_remote_localities().at(0);
-	const auto iterations = 100;
+HPX_PLAIN_ACTION(echo_function, echo_function_action)
 
-	// warmup
-	hpx::async<func_action>(remote, std::vector<char>(1000000, 'a')).get();
+std::pair<std::uint64_t, std::uint64_t> sent_payload_bytes() {
+	return {sent_payloads.bytes, sent_payloads.wire_bytes};
+}
+
+HPX_PLAIN_ACTION(sent_payload_bytes, sent_payload_bytes_action)
 
-	for (auto iteration = 0z; iteration < iterations; ++iteration) {
-		for (auto window_size : {1, 8, 64}) {
-			for (long msg_size = 1; msg_size <= 1'000'000'000 / window_size;
-			     msg_size *= 2) {
-				std::vector<std::vector<char>> data(
-					window_size, std::vector<char>(msg_size, 'a')
+// sends window_size messages at once and waits until all of them completed.
+// MB/s counts the payload of the messages only, for echo_function the same
+// amount travels back.
+template <typename Action>
+void bandwidth(
+	const hpx::id_type& target, const char* action_name, int iteration,
+	auto make_args
+) {
+	for (auto window_size : {1, 8, 64}) {
+		for (long msg_size = 1; msg_size <= 1'000'000'000 / window_size;
+		     msg_size *= 2) {
+			std::vector<decltype(make_args(msg_size))> args;
+			for (auto task = 0z; task < window_size; ++task) {
+				args.push_back(make_args(msg_size));
+			}
+			auto send = [&](auto& message) {
+				return std::apply(
+					[&](auto&... a) {
+						return hpx::async<Action>(target, std::move(a)...);
+					},
+					message
 				);
-				std::vector<hpx::future<void>> results(window_size);
+			};
+			std::vector<decltype(send(args[0]))> results(window_size);
+
+			auto t = hpx::chrono::high_resolution_timer{};
+			for (auto task = 0z; task < window_size; ++task) {
+				results[task] = send(args[task]);
+			}
+			hpx::when_all(results).get();
+			const auto elapsed = t.elapsed_microseconds();
+
+			hpx::util::format_to(
+				hpx::cout, "{},{},{},{},{},{}\n", action_name, window_size,
+				msg_size, iteration, elapsed,
+				double(msg_size) * window_size / elapsed
+			) << std::flush;
+		}
+	}
+}
+
+// round trips of execute_function shaped invocations, one at a time. async
+// waits on the returned future, post_c posts the action with a promise as its
+// continuation, which is how results are sent onwards without a future.
+void latency(
+	const hpx::id_type& target, const char* target_name, long samples
+) {
+	for (std::string mode : {"async", "post_c"}) {
+		for (long msg_size = 1; msg_size <= 64 << 20; msg_size *= 4) {
+			// at most about 1GB per message size
+			const auto count =
+				std::min(samples, std::max(10l, (1l << 30) / msg_size));
+			std::vector<double> latencies;
+			for (auto sample = 0l; sample < count; ++sample) {
+				compressible_bytes input{pooled_bytes(msg_size, 'a')};
 
 				auto t = hpx::chrono::high_resolution_timer{};
-				for (auto task = 0z; task < window_size; ++task) {
-					results[task] =
-						hpx::async<func_action>(remote, std::move(data[task]));
+				if (mode == "async") {
+					hpx::async<echo_function_action>(
+						target, std::uint32_t{0}, std::move(input)
+					)
+						.get();
+				} else {
+					hpx::distributed::promise<compressible_bytes> promise;
+					auto result = promise.get_future();
+					hpx::post_c<echo_function_action>(
+						promise.get_id(), target, std::uint32_t{0},
+						std::move(input)
+					);
+					result.get();
 				}
-				hpx::when_all(results).get();
-				const auto elapsed = t.elapsed_microseconds();
+				latencies.push_back(t.elapsed_microseconds());
+			}
 
-				hpx::util::format_to(
-					hpx::cout, "{},{},{},{},{}\n", window_size, msg_size,
-					iteration, elapsed, double(msg_size) * window_size / elapsed
-				)<<std::flush;
+			std::ranges::sort(latencies);
+			auto percentile = [&](double p) {
+				return latencies[std::min<std::size_t>(
+					latencies.size() - 1, p * latencies.size()
+				)];
+			};
+			hpx::util::format_to(
+				hpx::cout, "{},{},{},{},{},{},{},{}\n", target_name, mode,
+				msg_size, count, percentile(0.5), percentile(0.9),
+				percentile(0.99), latencies.back()
+			) << std::flush;
+		}
+	}
+}
+
+// round trips of execute_function shaped invocations with payloads that lz4
+// compresses well and ones it does not compress at all. run once with and once
+// without FAASHION_COMPRESS_PAYLOADS on all localities to compare, wire_bytes
+// counts what both sides serialized per round trip.
+void compression(const hpx::id_type& target, long samples) {
+	auto counters = [&] {
+		const auto [bytes, wire_bytes] =
+			hpx::async<sent_payload_bytes_action>(target).get();
+		return std::pair{
+			bytes + sent_payloads.bytes, wire_bytes + sent_payloads.wire_bytes};
+	};
+	std::mt19937 random;
+	for (std::string payload : {"repeated", "random"}) {
+		for (long msg_size = 64 << 10; msg_size <= 64 << 20; msg_size *= 4) {
+			const auto count =
+				std::min(samples, std::max(10l, (1l << 30) / msg_size));
+			pooled_bytes data(msg_size);
+			for (auto& byte : data) {
+				byte = payload == "repeated" ? 'a' : random();
 			}
+
+			const auto before = counters();
+			std::vector<double> latencies;
+			for (auto sample = 0l; sample < count; ++sample) {
+				compressible_bytes input{data};
+				auto t = hpx::chrono::high_resolution_timer{};
+				hpx::async<echo_function_action>(
+					target, std::uint32_t{0}, std::move(input)
+				)
+					.get();
+				latencies.push_back(t.elapsed_microseconds());
+			}
+			const auto after = counters();
+
+			std::ranges::sort(latencies);
+			hpx::util::format_to(
+				hpx::cout, "{},{},{},{},{},{},{}\n",
+				compression_threshold ? *compression_threshold : 0, payload,
+				msg_size, count, latencies[latencies.size() / 2],
+				latencies[std::min<std::size_t>(
+					latencies.size() - 1, 0.99 * latencies.size()
+				)],
+				(after.second - before.second) / count
+			) << std::flush;
 		}
 	}
+}
+
+int hpx_main(hpx::program_options::variables_map& vm) {
+	const auto benchmark = vm["benchmark"].as<std::string>();
+
+	if (benchmark == "compression") {
+		hpx::util::format_to(
+			hpx::cout, "threshold,payload,msg_size,samples,p50_µs,p99_µs,"
+					   "wire_bytes\n"
+		);
+		for (const auto& remote : hpx::find_remote_localities()) {
+			compression(remote, vm["samples"].as<long>());
+			break;
+		}
+		return hpx::finalize();
+	}
+
+	if (benchmark == "latency") {
+		hpx::util::format_to(
+			hpx::cout, "target,mode,msg_size,samples,p50_µs,p90_µs,p99_µs,"
+					   "max_µs\n"
+		);
+		const auto samples = vm["samples"].as<long>();
+		// warmup
+		hpx::async<echo_function_action>(
+			hpx::find_here(), std::uint32_t{0},
+			compressible_bytes{pooled_bytes(1)}
+		)
+			.get();
+		latency(hpx::find_here(), "local", samples);
+		for (const auto& remote : hpx::find_remote_localities()) {
+			hpx::async<echo_function_action>(
+				remote, std::uint32_t{0},
+				compressible_bytes{pooled_bytes(1000000)}
+			)
+				.get();
+			latency(remote, "remote", samples);
+			break;
+		}
+		return hpx::finalize();
+	}
+
+	hpx::util::format_to(hpx::cout, "action,window,msg_size,i,µs,MB/s\n");
+
+	const auto remote = hpx::find_remote_localities().at(0);
+	const auto iterations = 100;
+
+	// warmup
+	hpx::async<func_action>(remote, std::vector<char>(1000000, 'a')).get();
+
+	for (auto iteration = 0; iteration < iterations; ++iteration) {
+		bandwidth<func_action>(remote, "func", iteration, [](long size) {
+			return std::tuple{std::vector<char>(size, 'a')};
+		});
+		bandwidth<echo_function_action>(
+			remote, "execute_function", iteration,
+			[](long size) {
+				return std::tuple{
+					std::uint32_t{0},
+					compressible_bytes{pooled_bytes(size, 'a')}};
+			}
+		);
+	}
 	return hpx::finalize();
 }
 
-int main(int argc, char* argv[]) { return hpx::init(argc, argv); }
+int main(int argc, char* argv[]) {
+	hpx::program_options::options_description desc(
+		"usage: hpx_action_benchmark [options]"
+	);
+	desc.add_options()(
+		"benchmark",
+		hpx::program_options::value<std::string>()->default_value("bandwidth"),
+		"bandwidth, latency or compression"
+	)(
+		"samples", hpx::program_options::value<long>()->default_value(1000),
+		"round trips per message size and mode for latency and compression"
+	);
+
+	hpx::init_params params;
+	params.desc_cmdline = desc;
+	return hpx::init(argc, argv, params);
+}
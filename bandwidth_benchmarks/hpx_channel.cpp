@@ -9,8 +9,11 @@
 #include <hpx/include/runtime.hpp>
 #include <hpx/include/util.hpp>
 #include <hpx/iostream.hpp>
+#include <hpx/modules/program_options.hpp>
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <numeric>
 #include <string>
 #include <vector>
@@ -27,11 +30,87 @@ void func_chunk(hpx::lcos::channel<vector_t> input) {
 	for (auto d : input) {}
 }
 HPX_PLAIN_ACTION(func_chunk, func_chunk_action)
+// sends every chunk straight back, like a streaming function passing its input
+// through
+void echo_chunk(
+	hpx::lcos::channel<vector_t> input, hpx::lcos::channel<vector_t> output
+) {
+	for (auto d : input) {
+		output.set(std::move(d));
+	}
+	output.close();
+}
+HPX_PLAIN_ACTION(echo_chunk, echo_chunk_action)
 
-int hpx_main() {
-	hpx::util::format_to(hpx::cout, "method,msg_size,msg_count,µs,MB/s\n");
+// streams chunks through a remote echo over an input and an output channel,
+// like streaming_http_hpx does, with at most window chunks on their way. every
+// chunk's latency is the time from sending it until it came back.
+void echo(const hpx::id_type& remote) {
+	hpx::util::format_to(
+		hpx::cout,
+		"window,msg_size,msg_count,µs,MB/s,p50_µs,p90_µs,p99_µs,max_µs\n"
+	);
+	using clock = std::chrono::steady_clock;
+
+	for (auto window : {1z, 8z, 64z}) {
+		for (long msg_size = 1; msg_size <= 10'000'000; msg_size *= 4) {
+			hpx::lcos::channel<vector_t> input(hpx::find_here());
+			hpx::lcos::channel<vector_t> output(hpx::find_here());
+			auto res = hpx::async<echo_chunk_action>(remote, input, output);
+
+			// about 256MB each way, but between 100 and 100000 chunks
+			const auto msg_count =
+				std::clamp((256z << 20) / msg_size, 100z, 100'000z);
+			std::vector<clock::time_point> sent(msg_count);
+			std::vector<double> latencies;
+			latencies.reserve(msg_count);
+			auto receive = [&] {
+				output.get().get();
+				latencies.push_back(
+					std::chrono::duration<double, std::micro>(
+						clock::now() - sent[latencies.size()]
+					)
+						.count()
+				);
+			};
+
+			auto t = hpx::chrono::high_resolution_timer{};
+			for (auto i = 0z; i < msg_count; ++i) {
+				if (i - std::ssize(latencies) == window) {
+					receive();
+				}
+				sent[i] = clock::now();
+				input.set(vector_t(msg_size, 'a'));
+			}
+			input.close();
+			while (std::ssize(latencies) < msg_count) {
+				receive();
+			}
+			res.get();
+			const auto elapsed = t.elapsed_microseconds();
+
+			std::ranges::sort(latencies);
+			auto percentile = [&](double p) {
+				return latencies[std::size_t(p * latencies.size())];
+			};
+			hpx::util::format_to(
+				hpx::cout, "{},{},{},{},{},{},{},{},{}\n", window, msg_size,
+				msg_count, elapsed, double(msg_count) * msg_size / elapsed,
+				percentile(0.5), percentile(0.9), percentile(0.99),
+				latencies.back()
+			) << std::flush;
+		}
+	}
+}
 
+int hpx_main(hpx::program_options::variables_map& vm) {
 	const auto remote = hpx::find_remote_localities().at(0);
+	if (vm["benchmark"].as<std::string>() == "echo") {
+		echo(remote);
+		return hpx::finalize();
+	}
+
+	hpx::util::format_to(hpx::cout, "method,msg_size,msg_count,µs,MB/s\n");
 	const auto total_size = 100'000z;
 	const auto max_msg_size = 10'000'000z;
 
@@ -76,5 +155,16 @@ int hpx_main() {
 }
 
 int main(int argc, char* argv[]) {
-	return hpx::init(argc, argv); // Initialize and run HPX.
+	hpx::program_options::options_description desc(
+		"usage: hpx_channel_benchmark [options]"
+	);
+	desc.add_options()(
+		"benchmark",
+		hpx::program_options::value<std::string>()->default_value("one_way"),
+		"one_way or echo"
+	);
+
+	hpx::init_params params;
+	params.desc_cmdline = desc;
+	return hpx::init(argc, argv, params); // Initialize and run HPX.
 }
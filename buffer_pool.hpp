@@ -0,0 +1,191 @@
+
+// recycled buffers for request and response bodies. blocks are rounded up to a
+// power of two size class and kept on a free list of their class when they are
+// released, so the next body of a similar size reuses memory that is already
+// faulted in instead of going through malloc, which maps and unmaps blocks this
+// large on every request.
+//
+// FAASHION_BUFFER_POOL bounds the bytes kept on the free lists, 256MB by
+// default. bodies up to the largest class are pooled, larger ones are not.
+//
+// with FAASHION_NUMA every node has a pool of its own, which gets an equal
+// share of the bound. threads take blocks from and return them to the pool of
+// the node they run on, so memory first touched on a node is not handed to
+// requests served on another one.
+#pragma once
+
+#include "numa.hpp"
+#include "parse_size.hpp"
+
+#include <sched.h>
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+class buffer_pool {
+public:
+	static constexpr std::size_t min_class_size = 4 << 10;
+	static constexpr std::size_t max_class_size = 256 << 20;
+
+	explicit buffer_pool(std::size_t capacity) : capacity_(capacity) {}
+
+	buffer_pool(const buffer_pool&) = delete;
+	buffer_pool& operator=(const buffer_pool&) = delete;
+
+	~buffer_pool() {
+		for (auto& size_class : classes_) {
+			for (auto* block : size_class.free) {
+				::operator delete(block);
+			}
+		}
+	}
+
+	// the size of the block that holds bytes
+	static std::size_t block_size(std::size_t bytes) {
+		return bytes > max_class_size
+		           ? bytes
+		           : std::bit_ceil(std::max(bytes, min_class_size));
+	}
+
+	void* allocate(std::size_t bytes) {
+		const auto size = block_size(bytes);
+		if (size <= max_class_size) {
+			auto& size_class = class_of(size);
+			std::lock_guard lock{size_class.mutex};
+			if (!size_class.free.empty()) {
+				auto* block = size_class.free.back();
+				size_class.free.pop_back();
+				cached_ -= size;
+				return block;
+			}
+		}
+		return ::operator new(size);
+	}
+
+	void deallocate(void* block, std::size_t bytes) {
+		const auto size = block_size(bytes);
+		if (size <= max_class_size and reserve_cache(size)) {
+			auto& size_class = class_of(size);
+			std::lock_guard lock{size_class.mutex};
+			size_class.free.push_back(block);
+			return;
+		}
+		::operator delete(block);
+	}
+
+private:
+	struct size_class {
+		std::mutex mutex;
+		std::vector<void*> free;
+	};
+
+	static constexpr std::size_t class_count =
+		std::countr_zero(max_class_size) - std::countr_zero(min_class_size) +
+		1;
+
+	const std::size_t capacity_;
+	std::atomic<std::size_t> cached_ = 0;
+	std::array<size_class, class_count> classes_;
+
+	size_class& class_of(std::size_t size) {
+		return classes_
+			[std::countr_zero(size) - std::countr_zero(min_class_size)];
+	}
+
+	bool reserve_cache(std::size_t size) {
+		auto cached = cached_.load(std::memory_order_relaxed);
+		do {
+			if (size > capacity_ - std::min(cached, capacity_)) {
+				return false;
+			}
+		} while (!cached_.compare_exchange_weak(cached, cached + size));
+		return true;
+	}
+};
+
+// a buffer_pool per numa node, a single one without numa placement
+class node_buffer_pools {
+public:
+	explicit node_buffer_pools(std::size_t capacity) {
+		const auto nodes =
+			numa_placement ? numa_nodes() : std::vector<numa_node>(1);
+		for (std::size_t idx = 0; idx < nodes.size(); ++idx) {
+			for (auto cpu : nodes[idx].cpus) {
+				if (std::size_t(cpu) >= node_of_cpu_.size()) {
+					node_of_cpu_.resize(cpu + 1, 0);
+				}
+				node_of_cpu_[cpu] = idx;
+			}
+			pools_.push_back(
+				std::make_unique<buffer_pool>(capacity / nodes.size())
+			);
+		}
+	}
+
+	// the pool of the node the calling thread runs on
+	buffer_pool& local() {
+		if (pools_.size() == 1) {
+			return *pools_.front();
+		}
+		const auto cpu = sched_getcpu();
+		return *pools_
+			[cpu >= 0 and std::size_t(cpu) < node_of_cpu_.size()
+		         ? node_of_cpu_[cpu]
+		         : 0];
+	}
+
+private:
+	std::vector<std::size_t> node_of_cpu_;
+	std::vector<std::unique_ptr<buffer_pool>> pools_;
+};
+
+inline node_buffer_pools body_buffer_pools{[] {
+	const auto* capacity = std::getenv("FAASHION_BUFFER_POOL");
+	return capacity ? std::size_t(parse_size(capacity))
+	                : std::size_t(256) << 20;
+}()};
+
+// allocates from the local pool of body_buffer_pools. elements are default
+// initialized, a body resized to receive data is not zeroed first.
+template <typename T>
+struct pooled_allocator {
+	using value_type = T;
+
+	pooled_allocator() = default;
+	template <typename U>
+	pooled_allocator(const pooled_allocator<U>&) noexcept {}
+
+	T* allocate(std::size_t n) {
+		return static_cast<T*>(
+			body_buffer_pools.local().allocate(n * sizeof(T))
+		);
+	}
+	void deallocate(T* p, std::size_t n) noexcept {
+		body_buffer_pools.local().deallocate(p, n * sizeof(T));
+	}
+
+	template <typename U, typename... Args>
+	void construct(U* p, Args&&... args) {
+		if constexpr (sizeof...(Args) == 0) {
+			::new (static_cast<void*>(p)) U;
+		} else {
+			::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+		}
+	}
+
+	template <typename U>
+	bool operator==(const pooled_allocator<U>&) const noexcept {
+		return true;
+	}
+};
+
+using pooled_bytes = std::vector<std::uint8_t, pooled_allocator<std::uint8_t>>;
@@ -6,7 +6,9 @@
 // Distributed under the Boost Software License, Version 1.0. (See accompanying
 // file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
-#include "wasmtime.hh"
+#include "native_functions.hpp"
+#include "numa.hpp"
+#include "wasm_functions.hpp"
 #include <boost/asio.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
@@ -18,6 +20,7 @@
 #include <ctime>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <optional>
@@ -31,56 +34,26 @@ namespace http = beast::http;     // from <boost/beast/http.hpp>
 namespace net = boost::asio;      // from <boost/asio.hpp>
 using tcp = boost::asio::ip::tcp; // from <boost/asio/ip/tcp.hpp>
 
+// with FAASHION_REUSE_INSTANCES set, connections are kept alive if the client
+// asks for it, and consecutive requests of a connection to the same function
+// run in the same instance. the instance only gets the previous request's
+// buffers back through dealloc, so whatever else a request leaves in it is
+// visible to the next one. this is meant for trusted callers like internal
+// pipelines that push many small records through one function.
+const bool reuse_instances = std::getenv("FAASHION_REUSE_INSTANCES") != nullptr;
+
 // boost span range constructor seems broken
 template <typename T, std::size_t E>
 auto std2boost(std::span<T, E> s) {
 	return boost::span<T, E>{s.data(), s.size()};
 }
 
-std::string get_file_contents(const char* filename) {
-	std::ifstream in(filename, std::ios::in);
-	if (!in) {
-		throw std::runtime_error{std::strerror(errno)};
-	}
-
-	in.seekg(0, std::ios::end);
-	std::string contents(in.tellg(), 0);
-	in.seekg(0);
-	in.read(contents.data(), std::ranges::ssize(contents));
-	return contents;
-}
-
-// An engine is safe to share between threads. Multiple stores can be created
-// within the same engine with each store living on a separate thread. Typically
-// you'll create one
-// [wasm_engine_t](https://docs.wasmtime.dev/c-api/structwasm__engine__t.html
-// "Compilation environment and configuration.") for the lifetime of your
-// program.
-wasmtime::Engine global_wasmengine = wasmtime::Engine{};
-
-// stl containers are safe to read concurrently
-const std::unordered_map<std::string, wasmtime::Module> modules = [] {
-	std::unordered_map<std::string, wasmtime::Module> result;
-	for (const auto& entry : std::filesystem::directory_iterator{"functions"}) {
-		if (entry.is_regular_file() and entry.path().extension() == ".wat") {
-			result.emplace(
-				"/" + entry.path().stem().string(),
-				wasmtime::Module::compile(
-					global_wasmengine, get_file_contents(entry.path().c_str())
-				)
-					.unwrap()
-			);
-		}
-	}
-	return result;
-}();
-
 class http_connection : public std::enable_shared_from_this<http_connection> {
 public:
 	http_connection(tcp::socket socket)
-		: socket_(std::move(socket)), wasmtime_store_(global_wasmengine) {
-		request_parser_.body_limit(boost::none);
-	}
+		: socket_(std::move(socket)), wasmtime_store_(global_wasmengine) {}
+
+	~http_connection() { release_native_buffers(); }
 
 	// Initiate the asynchronous operations associated with the connection.
 	void start() {
@@ -98,13 +71,25 @@ private:
 	http::response<http::span_body<uint8_t>> response_;
 	http::response<http::string_body> string_response_;
 
-	http::request_parser<http::span_body<uint8_t>> request_parser_;
+	// parsers can not be reused, there is a new one for every request
+	std::optional<http::request_parser<http::span_body<uint8_t>>>
+		request_parser_;
+	bool keep_alive_ = false;
 
+	// the part of the memory budget the instance counts against, outlives it
+	std::optional<budget_reservation> memory_reservation_;
 	wasmtime::Store wasmtime_store_;
-	std::int32_t wasm_memory_offset_, wasm_memory_size_;
+	std::int32_t wasm_memory_offset_, wasm_memory_size_, wasm_output_offset_,
+		wasm_output_size_;
 
 	// no default constructer, can only be initialized once module is known
-	std::optional<wasmtime::Instance> wasm_instance_;
+	std::optional<function_instance> wasm_instance_;
+	const function_module* wasm_module_ = nullptr;
+
+	// set instead of the instance if the trusted native tier serves the path
+	const native_function* native_function_ = nullptr;
+	std::span<char> native_input_;
+	std::span<char> native_output_;
 
 	// The timer for putting a deadline on connection processing.
 	net::steady_timer deadline_{
@@ -112,15 +97,23 @@ private:
 
 	// Asynchronously receive a complete request message.
 	void read_request() {
+		request_parser_.emplace();
+		request_parser_->body_limit(boost::none);
+		keep_alive_ = false;
+
 		// read only header to be able to load correct module and then read the
 		// body into wasm memory directly.
 		http::async_read_header(
-			socket_, buffer_, request_parser_,
+			socket_, buffer_, *request_parser_,
 			[self = shared_from_this(
 			 )](beast::error_code ec, std::size_t bytes_transferred) {
 				boost::ignore_unused(bytes_transferred);
 				if (!ec) {
 					self->header_read();
+				} else if (ec == http::error::end_of_stream) {
+					// client closed a kept alive connection
+					self->socket_.shutdown(tcp::socket::shutdown_send, ec);
+					self->deadline_.cancel();
 				} else {
 					std::cerr << "error: " << ec.message() << "\n";
 				}
@@ -128,91 +121,232 @@ private:
 		);
 	}
 
+	void release_native_buffers() {
+		if (native_function_) {
+			native_function_->release(native_input_, native_output_);
+			native_function_->dealloc(native_input_.data());
+			native_function_ = nullptr;
+		}
+	}
+
+	// gives the previous request's buffers back to the instance. like for
+	// native_function::release, outputs are either a part of the input, which
+	// goes back with it, or an allocation of the function's own.
+	void release_wasm_buffers() {
+		wasm_instance_->dealloc->call(wasmtime_store_, wasm_memory_offset_)
+			.unwrap();
+		const bool within_input =
+			wasm_output_offset_ >= wasm_memory_offset_ and
+			std::int64_t(wasm_output_offset_) + wasm_output_size_ <=
+				std::int64_t(wasm_memory_offset_) + wasm_memory_size_;
+		if (wasm_output_size_ != 0 and !within_input) {
+			wasm_instance_->dealloc->call(wasmtime_store_, wasm_output_offset_)
+				.unwrap();
+		}
+	}
+
+	// instantiates module unless the previous request of this connection ran
+	// the same function and instances are reused. false if the memory budget
+	// is exhausted, requests are not queued as they would block the io thread.
+	bool prepare_instance(const function_module& module) {
+		if (reuse_instances and wasm_module_ == &module and
+		    wasm_instance_->dealloc) {
+			release_wasm_buffers();
+			return true;
+		}
+		if (wasm_instance_) {
+			// a fresh store drops the instance of the previous function
+			wasm_instance_.reset();
+			wasm_module_ = nullptr;
+			wasmtime_store_ = wasmtime::Store(global_wasmengine);
+		}
+		memory_reservation_.reset();
+		memory_reservation_ = try_reserve_memory(module.limits.charge());
+		if (!memory_reservation_) {
+			return false;
+		}
+		apply_limits(wasmtime_store_, module.limits);
+		wasm_instance_ = instantiate_function(wasmtime_store_, module);
+		wasm_module_ = &module;
+		return true;
+	}
+
 	// Determine what needs to be done with the request message.
 	void header_read() {
-		if (request_parser_.get().method() != http::verb::post) {
-			string_response_.result(http::status::bad_request);
-			string_response_.set(http::field::content_type, "text/plain");
-			string_response_.body() = "Invalid request-method.";
-			write_response(&http_connection::string_response_);
+		release_native_buffers();
+
+		if (request_parser_->get().method() != http::verb::post) {
+			write_error(http::status::bad_request, "Invalid request-method.");
+			return;
+		}
+
+		// trusted functions are served by the native tier if it provides them
+		if (auto native_it =
+		        native_functions.find(request_parser_->get().target());
+		    native_it != native_functions.end()) {
+			response_.set(
+				http::field::content_type, "application/octet-stream"
+			);
+
+			// the body is read into memory allocated by the function, just like
+			// for wasm modules. the limits configured for the path bound it.
+			const auto content_length = request_parser_->content_length();
+			if (!content_length) {
+				write_error(
+					http::status::length_required, "content length required\r\n"
+				);
+				return;
+			}
+			const auto limit =
+				limits_of(std::string{request_parser_->get().target()})
+					.max_input();
+			if (*content_length > limit) {
+				write_error(
+					http::status::payload_too_large,
+					"input exceeds the function's memory limit\r\n"
+				);
+				return;
+			}
+			const std::size_t size = *content_length;
+			auto* input = static_cast<char*>(native_it->second.alloc(size));
+			if (!input) {
+				write_error(
+					http::status::service_unavailable,
+					"function could not allocate the input\r\n"
+				);
+				return;
+			}
+			native_function_ = &native_it->second;
+			native_input_ = {input, size};
+			request_parser_->get().body() = std2boost(
+				std::span{reinterpret_cast<uint8_t*>(input), size}
+			);
+
+			read_body();
 			return;
 		}
 
 		// the precompiled modules map requires reading all modules at startup
 		// but avoids concurrency issues with cache
-		if (auto module_it = modules.find(request_parser_.get().target());
+		if (auto module_it = modules.find(request_parser_->get().target());
 		    module_it != modules.end()) {
 			response_.set(
 				http::field::content_type, "application/octet-stream"
 			);
 
+			// the body is received straight into the instance's memory, so
+			// its size has to be known up front and fit the function
+			const auto& module = module_it->second;
+			const auto content_length = request_parser_->content_length();
+			if (!content_length) {
+				write_error(
+					http::status::length_required, "content length required\r\n"
+				);
+				return;
+			}
+			if (*content_length > module.limits.max_input()) {
+				write_error(
+					http::status::payload_too_large,
+					"input exceeds the function's memory limit\r\n"
+				);
+				return;
+			}
+
 			// initialize module corresponding to this path
-			wasm_instance_ = wasmtime::Instance::create(
-								 wasmtime_store_, module_it->second, {}
-			)
-			                     .unwrap();
-			auto memory = std::get<wasmtime::Memory>(
-				/*memory must be available*/ *wasm_instance_->get(
-					wasmtime_store_, "memory"
-				)
-			);
+			try {
+				if (!prepare_instance(module)) {
+					write_error(
+						http::status::service_unavailable,
+						"memory budget exhausted\r\n"
+					);
+					return;
+				}
+			} catch (const std::exception& e) {
+				// e.g. a memory limit below the module's initial memory
+				std::cerr << "instantiation failed: " << e.what() << '\n';
+				wasm_module_ = nullptr;
+				memory_reservation_.reset();
+				write_error(
+					http::status::internal_server_error,
+					"function could not be instantiated\r\n"
+				);
+				return;
+			}
 
-			// allocate memory in module
-			// TODO: handle module not providing alloc
-			auto alloc = std::get<wasmtime::Func>(
-				wasm_instance_->get(wasmtime_store_, "alloc").value()
-			);
-			wasm_memory_size_ = 2'000'000'000;
+			// allocate memory in module, as much as the body needs
+			wasm_memory_size_ = std::int32_t(*content_length);
 			wasm_memory_offset_ =
-				alloc.call(wasmtime_store_, {wasm_memory_size_})
-					.unwrap()[0]
-					.i32();
+				wasm_instance_->alloc.call(wasmtime_store_, wasm_memory_size_)
+					.unwrap();
+			const auto memory = wasm_instance_->memory.data(wasmtime_store_);
+			if (wasm_memory_offset_ == 0 and wasm_memory_size_ != 0) {
+				// the memory could not grow enough below the limit
+				write_error(
+					http::status::payload_too_large,
+					"input exceeds the function's memory limit\r\n"
+				);
+				return;
+			}
+			if (!within_memory(
+					memory, wasm_memory_offset_, wasm_memory_size_
+				)) {
+				write_error(
+					http::status::internal_server_error,
+					"function returned an invalid allocation\r\n"
+				);
+				return;
+			}
 
-			assert(wasm_memory_offset_ != 0);
-			// TODO: handle allocation failure
-			//  set (to be filled) request body to allocated wasm memory
+			// set (to be filled) request body to allocated wasm memory
 			// memory will not be invalidated between here ...
-			// TODO: verify subspan in bounds, malicious module could return
-			// anything from alloc, would currently segfault
-			request_parser_.get().body() =
-				std2boost(memory.data(wasmtime_store_)
-			                  .subspan(wasm_memory_offset_, wasm_memory_size_));
+			request_parser_->get().body() = std2boost(
+				memory.subspan(wasm_memory_offset_, wasm_memory_size_)
+			);
 
 			// ... and here, where the memory is filled
-			http::async_read(
-				socket_, buffer_, request_parser_,
-				[self = shared_from_this(
-				 )](beast::error_code ec, std::size_t bytes_transferred) {
-					// according to docs, bytes_transferred does not count
-				    // leftover bytes in DynamicBuffer, but I could not observe
-				    // it, so we assume its correct to not resort to a hack
-					if (!ec) {
-						self->body_read(bytes_transferred);
-					} else {
-						std::cerr << "error: " << ec.message() << "\n";
-					}
-				}
-			);
+			read_body();
 			return;
 		}
 
-		string_response_.result(http::status::not_found);
-		string_response_.set(http::field::content_type, "text/plain");
-		string_response_.body() = "File not found\r\n";
-		write_response(&http_connection::string_response_);
+		write_error(http::status::not_found, "File not found\r\n");
 	}
 
-	void body_read(std::size_t bytes_transferred) {
-		auto function = std::get<wasmtime::Func>(
-			wasm_instance_->get(wasmtime_store_, "function").value()
-		);
-		auto get_output_size = std::get<wasmtime::Func>(
-			wasm_instance_->get(wasmtime_store_, "get_output_size").value()
+	void read_body() {
+		http::async_read(
+			socket_, buffer_, *request_parser_,
+			[self = shared_from_this(
+			 )](beast::error_code ec, std::size_t bytes_transferred) {
+				// according to docs, bytes_transferred does not count
+				// leftover bytes in DynamicBuffer, but I could not observe
+				// it, so we assume its correct to not resort to a hack
+				if (!ec) {
+					self->body_read(bytes_transferred);
+				} else {
+					std::cerr << "error: " << ec.message() << "\n";
+				}
+			}
 		);
+	}
+
+	void body_read(std::size_t bytes_transferred) {
+		// the whole body is read, so the next request can follow
+		keep_alive_ = reuse_instances and request_parser_->keep_alive();
+
+		if (native_function_) {
+			auto* offset = native_function_->function(
+				native_input_.data(), bytes_transferred
+			);
+			native_output_ = {offset, native_function_->get_output_size()};
+			response_.body() = std2boost(std::span{
+				reinterpret_cast<uint8_t*>(native_output_.data()),
+				native_output_.size()});
+			write_response(&http_connection::response_);
+			return;
+		}
 
 		// execute wasm function
-		const auto offset =
-			function
+		wasm_output_offset_ =
+			wasm_instance_->function
 				.call(
 					wasmtime_store_,
 					{wasm_memory_offset_,
@@ -221,31 +355,48 @@ private:
 		                     bytes_transferred
 		             )}
 				)
-				.unwrap()[0]
-				.i32();
-		const auto size =
-			get_output_size.call(wasmtime_store_, {}).unwrap()[0].i32();
-
-		auto memory = std::get<wasmtime::Memory>(
-			// memory, als well as wasm_instance are guaranteed to be there
-			*wasm_instance_->get(wasmtime_store_, "memory")
-		);
+				.unwrap();
+		wasm_output_size_ =
+			wasm_instance_->get_output_size.call(wasmtime_store_, {}).unwrap();
+		const auto memory = wasm_instance_->memory.data(wasmtime_store_);
+		if (!within_memory(memory, wasm_output_offset_, wasm_output_size_)) {
+			keep_alive_ = false;
+			write_error(
+				http::status::internal_server_error,
+				"function returned an invalid output\r\n"
+			);
+			return;
+		}
 
 		// assign output body to given memory region. the Memory will not be
 		// invalidated after this point, so the span is safe.
 		response_.body() =
-			std2boost(memory.data(wasmtime_store_).subspan(offset, size));
+			std2boost(memory.subspan(wasm_output_offset_, wasm_output_size_));
 
 		write_response(&http_connection::response_);
 	}
 
+	void write_error(http::status status, std::string message) {
+		string_response_.result(status);
+		string_response_.set(http::field::content_type, "text/plain");
+		string_response_.body() = std::move(message);
+		write_response(&http_connection::string_response_);
+	}
+
 	void write_response(auto http_connection::*response) {
 		(this->*response).content_length((this->*response).body().size());
-		(this->*response).keep_alive(false);
+		(this->*response).keep_alive(keep_alive_);
 
 		http::async_write(
 			socket_, this->*response,
 			[self = shared_from_this()](beast::error_code ec, std::size_t) {
+				if (!ec and self->keep_alive_) {
+					// every request gets the full deadline
+					self->deadline_.expires_after(std::chrono::seconds(60));
+					self->check_deadline();
+					self->read_request();
+					return;
+				}
 				self->socket_.shutdown(tcp::socket::shutdown_send, ec);
 				self->deadline_.cancel();
 			}
@@ -269,15 +420,20 @@ private:
 	}
 };
 
-// "Loop" forever accepting new connections.
-void http_server(tcp::acceptor& acceptor, tcp::socket& socket) {
+// "Loop" forever accepting new connections. route may move a socket to the
+// io_context that should serve it.
+void http_server(
+	tcp::acceptor& acceptor, tcp::socket& socket,
+	const std::function<tcp::socket(tcp::socket)>& route
+) {
 	acceptor.async_accept(socket, [&](beast::error_code ec) {
 		if (!ec) {
-			std::make_shared<http_connection>(std::move(socket))->start();
+			std::make_shared<http_connection>(route(std::move(socket)))
+				->start();
 		} else {
 			std::cerr << "error: " << ec.message() << "\n";
 		}
-		http_server(acceptor, socket);
+		http_server(acceptor, socket, route);
 	});
 }
 
@@ -289,16 +445,50 @@ int main(int argc, char* argv[]) {
 			std::stoi(std::getenv("SLURM_CPUS_PER_TASK"));
 		std::cerr << "threads: " << thread_count << '\n';
 
-		net::io_context ioc{thread_count};
+		// one io_context per numa node, with a thread pinned to the node for
+		// every cpu of it. otherwise a single io_context with thread_count
+		// threads that run anywhere.
+		const auto nodes =
+			numa_placement ? numa_nodes() : std::vector<numa_node>(1);
+		auto threads_of = [&](const numa_node& node) {
+			return numa_placement ? std::ssize(node.cpus) : thread_count;
+		};
+		std::vector<std::unique_ptr<net::io_context>> contexts;
+		std::vector<net::executor_work_guard<net::io_context::executor_type>>
+			work;
+		for (const auto& node : nodes) {
+			contexts.push_back(
+				std::make_unique<net::io_context>(threads_of(node))
+			);
+			work.push_back(net::make_work_guard(*contexts.back()));
+		}
+
+		auto& ioc = *contexts.front();
 		tcp::acceptor acceptor{ioc, {address, port}};
 		tcp::socket socket{ioc};
-		http_server(acceptor, socket);
+		http_server(acceptor, socket, [&](tcp::socket accepted) {
+			if (!numa_placement) {
+				return accepted;
+			}
+			const auto node = node_of_cpu(
+				nodes, incoming_cpu(accepted.native_handle())
+			);
+			const auto protocol = accepted.local_endpoint().protocol();
+			return tcp::socket{
+				*contexts[node], protocol, accepted.release()};
+		});
 
 		std::vector<std::thread> workers;
-		for (auto i = 0; i < thread_count - 1; ++i) {
-			workers.emplace_back([&ioc] { ioc.run(); });
+		for (std::size_t idx = 0; idx < nodes.size(); ++idx) {
+			for (auto i = 0; i < threads_of(nodes[idx]); ++i) {
+				workers.emplace_back([&, idx] {
+					if (numa_placement) {
+						pin_to_cpus(nodes[idx].cpus);
+					}
+					contexts[idx]->run();
+				});
+			}
 		}
-		ioc.run();
 		for (auto& worker : workers) {
 			worker.join();
 		}
@@ -307,4 +497,4 @@ int main(int argc, char* argv[]) {
 		std::cerr << "Error: " << e.what() << std::endl;
 		return EXIT_FAILURE;
 	}
-}
\ No newline at end of file
+}
@@ -6,26 +6,41 @@
 // Distributed under the Boost Software License, Version 1.0. (See accompanying
 // file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
-#include "wasmtime.hh"
+#include "buffer_pool.hpp"
+#include "function_registry.hpp"
+#include "h2c.hpp"
+#include "numa.hpp"
+#include "payload_compression.hpp"
 #include <boost/asio.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
 #include <boost/beast/version.hpp>
+#include <hpx/execution.hpp>
 #include <hpx/hpx_start.hpp>
 #include <hpx/include/runtime.hpp>
 #include <hpx/iostream.hpp>
+#include <hpx/thread.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <cstdlib>
 #include <ctime>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
 #define TIMING
 
@@ -37,6 +52,9 @@ namespace net = boost::asio;      // from <boost/asio.hpp>
 using tcp = boost::asio::ip::tcp; // from <boost/asio/ip/tcp.hpp>
 
 std::vector<hpx::id_type> localities;
+// localities bodies can be handed to as shared_payload, only filled in with
+// FAASHION_SHARED_PAYLOADS
+std::vector<bool> same_host;
 
 // boost span range constructor seems broken
 template <typename T, std::size_t E>
@@ -44,147 +62,382 @@ auto std2boost(std::span<T, E> s) {
 	return boost::span<T, E>{s.data(), s.size()};
 }
 
-std::string get_file_contents(const char* filename) {
-	std::ifstream in(filename, std::ios::in);
-	if (!in) {
-		throw std::runtime_error{std::strerror(errno)};
+// spreads the iterations of a parallel_for over the hpx worker threads. every
+// participating thread claims chunks of iterations and runs them in an instance
+// of its own that holds a copy of the input, the output slots are copied back
+// into the caller's memory. the calling thread takes part too and then spins
+// until the chunks running elsewhere are done. it must not suspend, its wasm
+// frames could be resumed on another worker, which wasmtime does not support.
+wasmtime::Result<std::monostate, wasmtime::Trap> parallel_for_hpx(
+	const function_module& module, wasmtime::Caller caller,
+	const parallel_for_args& args
+) {
+	// all offsets and sizes come from the guest
+	const auto caller_data = caller_memory(caller);
+	if (!parallel_for_in_bounds(caller_data, args)) {
+		return wasmtime::Trap{"parallel_for arguments exceed the memory"};
+	}
+	if (!parallel_for_body(
+			caller.context(), caller.get_export("__indirect_function_table"),
+			args.body
+		)) {
+		return wasmtime::Trap{"parallel_for body is not a function"};
 	}
 
-	in.seekg(0, std::ios::end);
-	std::string contents(in.tellg(), 0);
-	in.seekg(0);
-	in.read(contents.data(), std::ranges::ssize(contents));
-	return contents;
-}
+	struct shared_state {
+		// 64 bit, claiming chunks past end must not wrap around
+		std::atomic<std::int64_t> next;
+		std::atomic<int32_t> in_flight = 0;
+		std::mutex mutex;
+		std::optional<std::string> error;
+	};
+	auto state = std::make_shared<shared_state>();
+	state->next = args.begin;
+
+	const auto input = caller_data.subspan(args.input, args.input_size);
+	const auto threads = std::int32_t(hpx::get_num_worker_threads());
+	// a few chunks per thread even out iterations of different cost
+	const auto chunk_size = std::max<std::int64_t>(
+		1, (std::int64_t(args.end) - args.begin) / (4 * threads)
+	);
+	const auto chunk_output_size = chunk_size * args.stride;
+	if (chunk_output_size > std::numeric_limits<std::int32_t>::max()) {
+		return wasmtime::Trap{"parallel_for output exceeds the memory"};
+	}
 
-// An engine is safe to share between threads. Multiple stores can be created
-// within the same engine with each store living on a separate thread. Typically
-// you'll create one
-// [wasm_engine_t](https://docs.wasmtime.dev/c-api/structwasm__engine__t.html
-// "Compilation environment and configuration.") for the lifetime of your
-// program.
-wasmtime::Engine global_wasmengine = wasmtime::Engine{};
-
-// stl containers are safe to read concurrently
-const std::unordered_map<std::string, wasmtime::Module> modules = [] {
-	std::unordered_map<std::string, wasmtime::Module> result;
-	for (const auto& entry : std::filesystem::directory_iterator{"functions"}) {
-		if (entry.is_regular_file() and entry.path().extension() == ".wat") {
-			result.emplace(
-				"/" + entry.path().stem().string(),
-				wasmtime::Module::compile(
-					global_wasmengine, get_file_contents(entry.path().c_str())
-				)
-					.unwrap()
-			);
+	auto run = [=, &module] {
+		auto check = [](auto result) {
+			if (!result) {
+				throw std::runtime_error{result.err().message()};
+			}
+			return result.ok();
+		};
+		auto allocate = [&](function_instance& instance, wasmtime::Store& store,
+		                    std::int64_t size) {
+			const auto offset =
+				check(instance.alloc.call(store, std::int32_t(size)));
+			if ((offset == 0 and size != 0) or
+			    !within_memory(instance.memory.data(store), offset, size)) {
+				throw std::runtime_error{"parallel_for could not allocate"};
+			}
+			return offset;
+		};
+
+		std::optional<wasmtime::Store> store;
+		std::optional<function_instance> instance;
+		std::optional<wasmtime::Func> body;
+		std::int32_t input_offset = 0, output_offset = 0;
+		for (;;) {
+			++state->in_flight;
+			const auto chunk_begin = state->next.fetch_add(chunk_size);
+			if (chunk_begin >= args.end) {
+				--state->in_flight;
+				return;
+			}
+			const auto chunk_end =
+				std::min<std::int64_t>(args.end, chunk_begin + chunk_size);
+
+			try {
+				if (!store) {
+					// nested parallel_for calls run serially in the worker.
+					// the instance is not charged against the memory budget,
+					// waiting for it while the caller holds its share could
+					// deadlock.
+					store.emplace(global_wasmengine);
+					apply_limits(*store, module.limits);
+					instance = instantiate_function(*store, module);
+					body = parallel_for_body(
+						*store,
+						instance->instance.get(
+							*store, "__indirect_function_table"
+						),
+						args.body
+					);
+					if (!body) {
+						throw std::runtime_error{
+							"parallel_for body is not a function"};
+					}
+					input_offset =
+						allocate(*instance, *store, args.input_size);
+					output_offset =
+						allocate(*instance, *store, chunk_output_size);
+					std::ranges::copy(
+						input,
+						instance->memory.data(*store).begin() + input_offset
+					);
+				}
+
+				for (auto i = chunk_begin; i < chunk_end; ++i) {
+					check(body->call(
+						*store,
+						{std::int32_t(i), input_offset, args.input_size,
+				         std::int32_t(
+							 output_offset + (i - chunk_begin) * args.stride
+						 )}
+					));
+				}
+
+				// both ranges were checked, the one in the caller's memory
+				// with parallel_for_in_bounds
+				std::ranges::copy(
+					instance->memory.data(*store).subspan(
+						output_offset, (chunk_end - chunk_begin) * args.stride
+					),
+					caller_data.begin() + args.output +
+						(chunk_begin - args.begin) * args.stride
+				);
+			} catch (const std::exception& e) {
+				std::lock_guard lock{state->mutex};
+				state->error = e.what();
+				// don't hand out any further chunks
+				state->next = args.end;
+			}
+			--state->in_flight;
 		}
+	};
+
+	for (auto thread = 1; thread < threads; ++thread) {
+		hpx::post(run);
+	}
+	run();
+	while (state->in_flight != 0) {
+		// an os level yield, which keeps this hpx thread on its worker
+		std::this_thread::yield();
 	}
-	return result;
-}();
 
-std::vector<uint8_t>
-execute_function(std::string function_path, std::vector<uint8_t> input) {
-	// hpx::cout << "hello from " << hpx::get_locality_id() << std::endl;
+	std::lock_guard lock{state->mutex};
+	if (state->error) {
+		return wasmtime::Trap{*state->error};
+	}
+	return std::monostate{};
+}
+
+// an instance of a wasm function that runs once, on input_size bytes placed
+// into its memory at a page aligned offset
+class wasm_execution {
+public:
+	wasm_execution(const function_module& module, std::size_t input_size)
+		// counts against this locality's budget until the store is gone
+		: reservation_(reserve_memory(
+			  module.limits.charge(), [] { hpx::this_thread::yield(); }
+		  )),
+		  store_(global_wasmengine), input_size_(input_size) {
+		// the extra page leaves room to align the input and mapped inputs
+		// cover whole pages
+		const auto allocation_size = round_up_to_page(input_size) + page_size;
+		if (input_size > module.limits.max_input() or
+		    allocation_size > std::numeric_limits<std::int32_t>::max()) {
+			throw std::out_of_range{
+				"input exceeds the function's memory limit"};
+		}
+		apply_limits(store_, module.limits);
+
 #ifdef TIMING
-	timings[3] = std::chrono::steady_clock::now();
+		timings[5] = std::chrono::steady_clock::now();
 #endif
-	auto module_it = modules.find(function_path);
-	if (module_it == modules.end()) {
-		throw std::runtime_error{"function not found"};
-	}
+		// initialize module corresponding to this path
+		instance_.emplace(instantiate_function(
+			store_, module,
+			[&module](wasmtime::Caller caller, const parallel_for_args& args) {
+				return parallel_for_hpx(module, caller, args);
+			}
+		));
 
 #ifdef TIMING
-	timings[4] = std::chrono::steady_clock::now();
+		timings[6] = std::chrono::steady_clock::now();
+#endif
+		// the exports were looked up by instantiate_function
+#ifdef TIMING
+		timings[7] = std::chrono::steady_clock::now();
 #endif
 
-	std::int32_t wasm_memory_size = 2'000'000'000;
-	assert(input.size() <= wasm_memory_size);
-	wasmtime::Store wasmtime_store(global_wasmengine);
+		// allocate memory in module. only the input is allocated, the memory
+		// limit of a function may be far below the 2GB modules used to get.
+		std::int32_t wasm_memory_offset =
+			instance_->alloc.call(store_, std::int32_t(allocation_size))
+				.unwrap();
 
 #ifdef TIMING
-	timings[5] = std::chrono::steady_clock::now();
+		timings[8] = std::chrono::steady_clock::now();
 #endif
-	// initialize module corresponding to this path
-	auto wasm_instance =
-		wasmtime::Instance::create(wasmtime_store, module_it->second, {})
-			.unwrap();
 
+		// out_of_range is answered with 413, hpx rethrows it as such
+		if (wasm_memory_offset == 0) {
+			throw std::out_of_range{
+				"input exceeds the function's memory limit"};
+		}
+		if (!within_memory(
+				instance_->memory.data(store_), wasm_memory_offset,
+				std::int64_t(allocation_size)
+			)) {
+			throw std::runtime_error{"function returned an invalid allocation"};
+		}
+		// aligning the input keeps it inside the allocation
+		input_offset_ = std::int32_t(round_up_to_page(wasm_memory_offset));
+	}
+
+	wasm_execution(const wasm_execution&) = delete;
+	wasm_execution& operator=(const wasm_execution&) = delete;
+
+	// place_input(memory, offset) puts the input into the instance's memory
+	void place_input(auto place) {
+		// the allocation was checked to hold the input
+		place(instance_->memory.data(store_), input_offset_);
+	}
+
+	// runs the function, its output stays valid as long as the instance
+	std::span<const std::uint8_t> run() {
 #ifdef TIMING
-	timings[6] = std::chrono::steady_clock::now();
+		timings[9] = std::chrono::steady_clock::now();
 #endif
-	auto memory = std::get<wasmtime::Memory>(
-		/*memory must be available*/ *wasm_instance.get(
-			wasmtime_store, "memory"
-		)
-	);
+		// execute wasm function
+		const auto offset =
+			instance_->function
+				.call(
+					store_, {input_offset_,
+		                     int32_t(/*body can be at most wasm_memory_size,
+		                                so should never overflow*/
+		                             input_size_
+		                     )}
+				)
+				.unwrap();
+
 #ifdef TIMING
-	timings[7] = std::chrono::steady_clock::now();
+		timings[10] = std::chrono::steady_clock::now();
 #endif
+		const auto size =
+			instance_->get_output_size.call(store_, {}).unwrap();
+		const auto memory = instance_->memory.data(store_);
+		if (!within_memory(memory, offset, size)) {
+			throw std::runtime_error{"function returned an invalid output"};
+		}
+		return memory.subspan(offset, size);
+	}
 
-	// allocate memory in module
-	// we could allocate only the needed space in this case but it is probably
-	// better to keep the determinism
-	// TODO: handle module not providing alloc
-	auto alloc = std::get<wasmtime::Func>(
-		wasm_instance.get(wasmtime_store, "alloc").value()
-	);
-	std::int32_t wasm_memory_offset =
-		alloc.call(wasmtime_store, {wasm_memory_size}).unwrap()[0].i32();
+private:
+	budget_reservation reservation_;
+	wasmtime::Store store_;
+	std::optional<function_instance> instance_;
+	std::size_t input_size_;
+	std::int32_t input_offset_;
+};
 
+// runs a wasm function on input_size bytes that place_input puts into the
+// instance's memory at a page aligned offset
+pooled_bytes execute_wasm(
+	const function_module& module, std::size_t input_size, auto place_input
+) {
 #ifdef TIMING
-	timings[8] = std::chrono::steady_clock::now();
+	timings[4] = std::chrono::steady_clock::now();
 #endif
+	wasm_execution execution{module, input_size};
+	execution.place_input(place_input);
+	const auto output = execution.run();
+	return pooled_bytes(output.begin(), output.end());
+}
 
-	assert(wasm_memory_offset != 0);
-	// TODO: handle allocation failure
-	//  set (to be filled) request body to allocated wasm memory
-	// memory will not be invalidated between here ...
-	// TODO: verify subspan in bounds, malicious module could return
-	// anything from alloc, would currently segfault
-	// should not buffer overflow since input.size() constrained previously
-	std::ranges::copy(
-		input, memory.data(wasmtime_store).begin() + wasm_memory_offset
-	);
-
+// bodies cross localities as compressible_bytes, see payload_compression.hpp
+compressible_bytes
+execute_function(std::uint32_t function_id, compressible_bytes input) {
+	// hpx::cout << "hello from " << hpx::get_locality_id() << std::endl;
 #ifdef TIMING
-	timings[9] = std::chrono::steady_clock::now();
+	timings[3] = std::chrono::steady_clock::now();
 #endif
-	auto function = std::get<wasmtime::Func>(
-		wasm_instance.get(wasmtime_store, "function").value()
-	);
-	auto get_output_size = std::get<wasmtime::Func>(
-		wasm_instance.get(wasmtime_store, "get_output_size").value()
-	);
+	const auto& function = function_ids[function_id];
+	// trusted functions are served by the native tier if it provides them
+	if (function.native) {
+		return {(*function.native)(std::move(input.bytes))};
+	}
+	return {execute_wasm(
+		*function.wasm, input.bytes.size(),
+		[&input](std::span<std::uint8_t> memory, std::int32_t offset) {
+			std::ranges::copy(input.bytes, memory.begin() + offset);
+		}
+	)};
+}
+HPX_PLAIN_ACTION(execute_function, execute_function_action)
 
-	// execute wasm function
-	const auto offset =
-		function
-			.call(
-				wasmtime_store, {wasm_memory_offset,
-	                             int32_t(/*body can be at most wasm_memory_size,
-	                                        so should never overflow*/
-	                                     input.size()
-	                             )}
-			)
-			.unwrap()[0]
-			.i32();
+// runs the stages of a pipeline one after the other, the output of a stage is
+// the input of the next. a wasm stage's output is copied out of its instance,
+// which is dropped together with its share of the memory budget before the
+// next stage reserves its own. a pipeline never holds the budget of two stages,
+// waiting for the second while holding the first could deadlock.
+compressible_bytes execute_pipeline(
+	std::vector<std::uint32_t> stages, compressible_bytes payload
+) {
+	auto input = std::move(payload.bytes);
+	for (auto id : stages) {
+		const auto& function = function_ids[id];
+		if (function.native) {
+			input = (*function.native)(std::move(input));
+			continue;
+		}
+		input = execute_wasm(
+			*function.wasm, input.size(),
+			[&input](std::span<std::uint8_t> memory, std::int32_t offset) {
+				std::ranges::copy(input, memory.begin() + offset);
+			}
+		);
+	}
+	return {std::move(input)};
+}
+HPX_PLAIN_ACTION(execute_pipeline, execute_pipeline_action)
 
+// execute_function for a body in a memfd on this host. with
+// FAASHION_MAP_INPUTS wasm functions get it mapped into their memory instead
+// of copied.
+pooled_bytes
+execute_function_mapped(std::uint32_t function_id, const memfd_buffer& input) {
 #ifdef TIMING
-	timings[10] = std::chrono::steady_clock::now();
+	timings[3] = std::chrono::steady_clock::now();
 #endif
-	const auto size =
-		get_output_size.call(wasmtime_store, {}).unwrap()[0].i32();
+	const auto& function = function_ids[function_id];
+	if (function.native) {
+		const auto data = input.data();
+		return (*function.native)(pooled_bytes(data.begin(), data.end()));
+	}
+	return execute_wasm(
+		*function.wasm, input.data().size(),
+		[&input](std::span<std::uint8_t> memory, std::int32_t offset) {
+			if (map_inputs) {
+				map_into(memory, offset, input.fd(), input.data().size());
+			} else {
+				std::ranges::copy(input.data(), memory.begin() + offset);
+			}
+		}
+	);
+}
 
-	auto output = memory.data(wasmtime_store).subspan(offset, size);
-	return std::vector<uint8_t>(output.begin(), output.end());
+// execute_function for a body another process on this host received into a
+// memfd_buffer. the action only carries the descriptor, the body never goes
+// through the parcelport.
+compressible_bytes
+execute_function_shared(std::uint32_t function_id, shared_payload payload) {
+	const auto input =
+		memfd_buffer::open_shared(payload.pid, payload.fd, payload.size);
+	return {execute_function_mapped(function_id, input)};
 }
-HPX_PLAIN_ACTION(execute_function, execute_function_action)
+HPX_PLAIN_ACTION(execute_function_shared, execute_function_shared_action)
+
+std::string locality_host_identity() { return host_identity(); }
+HPX_PLAIN_ACTION(locality_host_identity, locality_host_identity_action)
+
+std::uint64_t function_registry_fingerprint() {
+	return function_ids.fingerprint();
+}
+HPX_PLAIN_ACTION(
+	function_registry_fingerprint, function_registry_fingerprint_action
+)
 
 class http_connection : public std::enable_shared_from_this<http_connection> {
 public:
-	http_connection(tcp::socket socket, std::ptrdiff_t locality_id_idx)
-		: locality_id_idx(locality_id_idx), socket_(std::move(socket)) {
-		request_parser_.body_limit(boost::none);
+	http_connection(
+		tcp::socket socket, std::ptrdiff_t locality_id_idx,
+		std::optional<std::int16_t> numa_node = std::nullopt
+	)
+		: locality_id_idx(locality_id_idx), numa_node_(numa_node),
+		  socket_(std::move(socket)) {
+		header_parser_.body_limit(boost::none);
 	}
 
 	// Initiate the asynchronous operations associated with the connection.
@@ -195,6 +448,8 @@ public:
 
 private:
 	std::ptrdiff_t locality_id_idx;
+	// the node this connection was received on, if placement is numa aware
+	std::optional<std::int16_t> numa_node_;
 
 	// The socket for the currently connected client.
 	tcp::socket socket_;
@@ -202,27 +457,35 @@ private:
 	// The buffer for performing reads.
 	beast::flat_buffer buffer_{8192};
 
-	http::response<http::vector_body<uint8_t>> response_;
+	// bodies are pooled, see buffer_pool.hpp. the parser reserves a body from
+	// its content length.
+	http::response<http::vector_body<uint8_t, pooled_allocator<uint8_t>>>
+		response_;
 	http::response<http::string_body> string_response_;
 
-	http::request_parser<http::vector_body<uint8_t>> request_parser_;
+	// the header is read first, the body parser is chosen after it
+	http::request_parser<http::empty_body> header_parser_;
+	std::optional<http::request_parser<
+		http::vector_body<uint8_t, pooled_allocator<uint8_t>>>>
+		request_parser_;
+	// bodies of requests executed on this locality are received into a memfd
+	// if inputs are mapped
+	std::optional<memfd_buffer> mapped_body_;
+	std::optional<http::request_parser<http::span_body<uint8_t>>>
+		mapped_parser_;
+	// the stages if the target is a pipeline like /reverse|/compute
+	std::vector<std::uint32_t> pipeline_;
 
 	// The timer for putting a deadline on connection processing.
 	net::steady_timer deadline_{
 		socket_.get_executor(), std::chrono::seconds(60)};
 
-	// Asynchronously receive a complete request message.
 	void read_request() {
-		http::async_read(
-			socket_, buffer_, request_parser_,
-			[self = shared_from_this(
-			 )](beast::error_code ec, std::size_t bytes_transferred) {
-#ifdef TIMING
-				timings[1] = std::chrono::steady_clock::now();
-#endif
-				boost::ignore_unused(bytes_transferred);
+		http::async_read_header(
+			socket_, buffer_, header_parser_,
+			[self = shared_from_this()](beast::error_code ec, std::size_t) {
 				if (!ec) {
-					self->request_read();
+					self->header_read();
 				} else {
 					std::cerr << "error: " << ec.message() << "\n";
 				}
@@ -231,8 +494,8 @@ private:
 	}
 
 	// Determine what needs to be done with the request message.
-	void request_read() {
-		if (request_parser_.get().method() != http::verb::post) {
+	void header_read() {
+		if (header_parser_.get().method() != http::verb::post) {
 			string_response_.result(http::status::bad_request);
 			string_response_.set(http::field::content_type, "text/plain");
 			string_response_.body() = "Invalid request-method.";
@@ -240,30 +503,165 @@ private:
 			return;
 		}
 
+		// resolved once here, the action only carries the id
+		const auto target = header_parser_.get().target();
+		const std::string_view path{target.data(), target.size()};
+		auto function_id = function_ids.find(path);
+		if (auto stages = function_id ? std::nullopt
+		                              : function_ids.find_pipeline(path)) {
+			pipeline_ = std::move(*stages);
+			function_id = pipeline_.front();
+		}
+		if (!function_id) {
+			string_response_.result(http::status::not_found);
+			string_response_.set(http::field::content_type, "text/plain");
+			string_response_.body() = "function not found\r\n";
+			write_response(&http_connection::string_response_);
+			return;
+		}
+
+		// bodies too large for the function are refused before they are
+		// received, see function_limits::max_input
+		const auto content_length = header_parser_.content_length();
+		const auto& function = function_ids[*function_id];
+		if (content_length and !function.native and
+		    *content_length > function.wasm->limits.max_input()) {
+			string_response_.result(http::status::payload_too_large);
+			string_response_.set(http::field::content_type, "text/plain");
+			string_response_.body() =
+				"input exceeds the function's memory limit\r\n";
+			write_response(&http_connection::string_response_);
+			return;
+		}
+
+		// bodies for this locality are mapped, ones for other localities on
+		// this host are handed over in the memfd
+		const bool local = localities[locality_id_idx] == hpx::find_here();
+		if (content_length and pipeline_.empty() and
+		    (local ? map_inputs
+		           : shared_payloads and same_host[locality_id_idx])) {
+			mapped_body_.emplace(*content_length);
+			mapped_parser_.emplace(std::move(header_parser_));
+			mapped_parser_->get().body() = std2boost(mapped_body_->data());
+			read_body(*mapped_parser_, *function_id);
+		} else {
+			request_parser_.emplace(std::move(header_parser_));
+			read_body(*request_parser_, *function_id);
+		}
+	}
+
+	// Asynchronously receive the rest of the request message.
+	void read_body(auto& parser, std::uint32_t function_id) {
+		http::async_read(
+			socket_, buffer_, parser,
+			[self = shared_from_this(),
+		     function_id](beast::error_code ec, std::size_t bytes_transferred) {
+#ifdef TIMING
+				timings[1] = std::chrono::steady_clock::now();
+#endif
+				boost::ignore_unused(bytes_transferred);
+				if (!ec) {
+					self->request_read(function_id);
+				} else {
+					std::cerr << "error: " << ec.message() << "\n";
+				}
+			}
+		);
+	}
+
+	void request_read(std::uint32_t function_id) {
 		response_.set(http::field::content_type, "application/octet-stream");
 
+		// local requests run on a worker of the node that received them. hpx
+		// numbers the numa domains it is bound to like numa_nodes().
+		hpx::execution::parallel_executor executor;
+		if (numa_node_) {
+			using hpx::threads::thread_schedule_hint_mode;
+			executor = hpx::execution::parallel_executor{
+				hpx::threads::thread_schedule_hint{
+					thread_schedule_hint_mode::numa, *numa_node_}};
+		}
+
 		// synchronizes with hpx thread
-		hpx::post([self = shared_from_this()] {
+		hpx::post(executor, [self = shared_from_this(), function_id] {
 #ifdef TIMING
 			timings[2] = std::chrono::steady_clock::now();
 #endif
-			execute_function_action f;
 			try {
-				self->response_.body() =
-					f(localities[self->locality_id_idx],
-				      self->request_parser_.get().target(),
-				      std::move(self->request_parser_.get().body()));
+				if (self->mapped_body_ and
+				    localities[self->locality_id_idx] == hpx::find_here()) {
+					self->response_.body() = execute_function_mapped(
+						function_id, *self->mapped_body_
+					);
+				} else if (self->mapped_body_) {
+					// the memfd stays open with the connection until the
+					// action returned
+					const auto& body = *self->mapped_body_;
+					execute_function_shared_action f;
+					self->response_.body() =
+						f(localities[self->locality_id_idx], function_id,
+					      shared_payload{
+							  getpid(), body.fd(), body.data().size()})
+							.bytes;
+				} else if (!self->pipeline_.empty()) {
+					// all stages run on one locality, intermediate outputs
+					// never leave it
+					execute_pipeline_action f;
+					self->response_.body() =
+						f(localities[self->locality_id_idx],
+					      std::move(self->pipeline_),
+					      compressible_bytes{
+							  std::move(self->request_parser_->get().body())})
+							.bytes;
+				} else if (self->numa_node_ and
+				           localities[self->locality_id_idx] ==
+				               hpx::find_here()) {
+					// an action would run on a worker of any node
+					self->response_.body() =
+						execute_function(
+							function_id,
+							{std::move(self->request_parser_->get().body())}
+						)
+							.bytes;
+				} else {
+					execute_function_action f;
+					self->response_.body() =
+						f(localities[self->locality_id_idx], function_id,
+					      compressible_bytes{
+							  std::move(self->request_parser_->get().body())})
+							.bytes;
+				}
 #ifdef TIMING
 				timings[11] = std::chrono::steady_clock::now();
 #endif
 				self->write_response(&http_connection::response_);
+			} catch (const std::bad_alloc&) {
+				// refused by the memory budget of the executing locality
+				self->string_response_.result(
+					http::status::service_unavailable
+				);
+				self->string_response_.set(
+					http::field::content_type, "text/plain"
+				);
+				self->string_response_.body() = "memory budget exhausted\r\n";
+				self->write_response(&http_connection::string_response_);
+			} catch (const std::out_of_range&) {
+				self->string_response_.result(http::status::payload_too_large);
+				self->string_response_.set(
+					http::field::content_type, "text/plain"
+				);
+				self->string_response_.body() =
+					"input exceeds the function's memory limit\r\n";
+				self->write_response(&http_connection::string_response_);
 			} catch (const std::exception& e) {
 				std::cerr << "action threw: " << e.what() << '\n';
-				self->string_response_.result(http::status::not_found);
+				self->string_response_.result(
+					http::status::internal_server_error
+				);
 				self->string_response_.set(
 					http::field::content_type, "text/plain"
 				);
-				self->string_response_.body() = "function not found\r\n";
+				self->string_response_.body() = "function failed\r\n";
 				self->write_response(&http_connection::string_response_);
 			}
 		});
@@ -289,6 +687,8 @@ private:
 				}
 				std::cerr << '\n';
 #endif
+				// back to the pool, the connection may outlive the write
+				self->response_.body() = pooled_bytes{};
 				self->socket_.shutdown(tcp::socket::shutdown_send, ec);
 				self->deadline_.cancel();
 			}
@@ -312,27 +712,116 @@ private:
 	}
 };
 
-// "Loop" forever accepting new connections.
+// "Loop" forever accepting new connections. with numa placement, connections
+// are served by the io_context in contexts of the node that received them.
 void http_server(
 	tcp::acceptor& acceptor, tcp::socket& socket,
-	std::ptrdiff_t round_robin_index
+	std::ptrdiff_t round_robin_index, const std::vector<numa_node>& nodes,
+	std::vector<std::unique_ptr<net::io_context>>& contexts
 ) {
 	acceptor.async_accept(socket, [&, round_robin_index](beast::error_code ec) {
 #ifdef TIMING
 		timings[0] = std::chrono::steady_clock::now();
 #endif
-		if (!ec) {
+		if (!ec and numa_placement) {
+			const auto node =
+				node_of_cpu(nodes, incoming_cpu(socket.native_handle()));
+			const auto protocol = socket.local_endpoint().protocol();
+			std::make_shared<http_connection>(
+				tcp::socket{*contexts[node], protocol, socket.release()},
+				round_robin_index, std::int16_t(node)
+			)
+				->start();
+		} else if (!ec) {
 			std::make_shared<http_connection>(
 				std::move(socket), round_robin_index
 			)
 				->start();
 		}
 		http_server(
-			acceptor, socket, (round_robin_index + 1) % std::ssize(localities)
+			acceptor, socket, (round_robin_index + 1) % std::ssize(localities),
+			nodes, contexts
 		);
 	});
 }
 
+// serves the streams of h2c connections like http_connection serves requests,
+// the connection's streams are spread over the localities
+void serve_h2c_stream(
+	std::shared_ptr<h2c_stream> stream, std::ptrdiff_t locality_id_idx
+) {
+	if (stream->method != "POST") {
+		stream->respond(400, "Invalid request-method.");
+		return;
+	}
+	const auto function_id = function_ids.find(stream->path);
+	auto stages =
+		function_id ? std::nullopt : function_ids.find_pipeline(stream->path);
+	if (!function_id and !stages) {
+		stream->respond(404, "function not found\r\n");
+		return;
+	}
+
+	// bodies too large for the function are refused before they are received
+	// if they announce their length, otherwise once they grow past the limit.
+	// pipelines are limited by their first stage like in header_read.
+	const auto& function = function_ids[function_id ? *function_id
+	                                                : stages->front()];
+	const auto max_input = function.native ? function_limits{}.max_input()
+	                                       : function.wasm->limits.max_input();
+	if (stream->content_length and *stream->content_length > max_input) {
+		stream->respond(413, "input exceeds the function's memory limit\r\n");
+		return;
+	}
+
+	stream->on_end = [stream, locality_id_idx, function_id,
+	                  stages = std::move(stages)] {
+		hpx::post([stream, locality_id_idx, function_id, stages] {
+			try {
+				const auto& locality = localities[locality_id_idx];
+				stream->respond(
+					200, "application/octet-stream",
+					stages ? execute_pipeline_action{}(
+								 locality, *stages,
+								 compressible_bytes{std::move(stream->body)}
+							 )
+								 .bytes
+						   : execute_function_action{}(
+								 locality, *function_id,
+								 compressible_bytes{std::move(stream->body)}
+							 )
+								 .bytes
+				);
+			} catch (const std::bad_alloc&) {
+				stream->respond(503, "memory budget exhausted\r\n");
+			} catch (const std::out_of_range&) {
+				stream->respond(
+					413, "input exceeds the function's memory limit\r\n"
+				);
+			} catch (const std::exception& e) {
+				std::cerr << "action threw: " << e.what() << '\n';
+				stream->respond(500, "function failed\r\n");
+			}
+		});
+	};
+	// collects the body, the window is given back for refused bodies as well.
+	// a refused body has no on_end left to run the function.
+	stream->on_data = [stream,
+	                   max_input](std::span<const std::uint8_t> bytes) {
+		stream->consume(bytes.size());
+		if (!stream->on_end) {
+			return;
+		}
+		if (bytes.size() > max_input - stream->body.size()) {
+			stream->on_end = nullptr;
+			stream->body = pooled_bytes{};
+			stream->reset();
+			return;
+		}
+		stream->body.insert(stream->body.end(), bytes.begin(), bytes.end());
+	};
+}
+
 int main(int argc, char* argv[]) {
 	try {
 		// Initialize HPX, don't run hpx_main
@@ -344,19 +833,80 @@ int main(int argc, char* argv[]) {
 		// we don't want to run asio on a hpx thread, but on the main thread, so
 		// we cant use hpx_main
 		if (hpx::find_here() == hpx::find_root_locality()) {
+			// function ids are only meaningful if all localities assign the
+			// same ones
+			for (const auto& locality : localities) {
+				if (hpx::async<function_registry_fingerprint_action>(locality)
+				        .get() != function_ids.fingerprint()) {
+					throw std::runtime_error{
+						"localities serve different functions"};
+				}
+			}
+			if (shared_payloads) {
+				for (const auto& locality : localities) {
+					same_host.push_back(
+						hpx::async<locality_host_identity_action>(locality)
+							.get() == host_identity()
+					);
+				}
+			}
+
 			auto const address = net::ip::make_address("127.0.0.1");
 			unsigned short port = 32425;
 
-			net::io_context ioc{1};
+			// a single threaded io_context per numa node, the one of the first
+			// node runs on this thread
+			const auto nodes =
+				numa_placement ? numa_nodes() : std::vector<numa_node>(1);
+			std::vector<std::unique_ptr<net::io_context>> contexts;
+			std::vector<
+				net::executor_work_guard<net::io_context::executor_type>>
+				work;
+			for (std::size_t idx = 0; idx < nodes.size(); ++idx) {
+				contexts.push_back(std::make_unique<net::io_context>(1));
+				work.push_back(net::make_work_guard(*contexts.back()));
+			}
+
+			auto& ioc = *contexts.front();
 			tcp::acceptor acceptor{ioc, {address, port}};
 			tcp::socket socket{ioc};
-			http_server(acceptor, socket, 0);
+			http_server(acceptor, socket, 0, nodes, contexts);
+
+			std::optional<tcp::acceptor> h2c_acceptor;
+			std::optional<tcp::socket> h2c_socket;
+			if (h2c_port) {
+				h2c_acceptor.emplace(ioc, tcp::endpoint{address, *h2c_port});
+				h2c_socket.emplace(ioc);
+				h2c_server(
+					*h2c_acceptor, *h2c_socket,
+					[round_robin_index = std::ptrdiff_t(0)](
+						std::shared_ptr<h2c_stream> stream
+					) mutable {
+						serve_h2c_stream(std::move(stream), round_robin_index);
+						round_robin_index =
+							(round_robin_index + 1) % std::ssize(localities);
+					}
+				);
+			}
 
 			hpx::cout << "WELCOME, bulk hpx running. Webserver locality:"
 					  << std::endl;
 			std::system("hostname");
 
+			std::vector<std::thread> io_threads;
+			for (std::size_t idx = 1; idx < nodes.size(); ++idx) {
+				io_threads.emplace_back([&, idx] {
+					pin_to_cpus(nodes[idx].cpus);
+					contexts[idx]->run();
+				});
+			}
+			if (numa_placement) {
+				pin_to_cpus(nodes.front().cpus);
+			}
 			ioc.run();
+			for (auto& thread : io_threads) {
+				thread.join();
+			}
 
 			// this shutdown is not clean at all, but it does not matter for our
 			// purposes
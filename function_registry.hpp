@@ -0,0 +1,135 @@
+
+// dense ids for the functions of a runtime. ids follow the sorted function
+// paths, so every locality that serves the same functions assigns the same
+// ids and actions can name a function by id instead of by path.
+#pragma once
+
+#include "native_functions.hpp"
+#include "wasm_functions.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct registered_function {
+	std::string path;
+	// the native tier is preferred if it provides the function
+	const native_function* native = nullptr;
+	const function_module* wasm = nullptr;
+};
+
+class function_registry {
+public:
+	function_registry() {
+		for (const auto& [path, module] : modules) {
+			functions_.push_back({path, nullptr, &module});
+		}
+		for (const auto& [path, function] : native_functions) {
+			auto it = std::ranges::find(
+				functions_, path, &registered_function::path
+			);
+			if (it == functions_.end()) {
+				functions_.push_back({path, &function, nullptr});
+			} else {
+				it->native = &function;
+			}
+		}
+		std::ranges::sort(functions_, {}, &registered_function::path);
+
+		for (const auto& function : functions_) {
+			fingerprint_ = hash(fingerprint_, function.path);
+		}
+		build_slots();
+	}
+
+	// resolves a request target with a single hash and compare
+	std::optional<std::uint32_t> find(std::string_view path) const {
+		const auto id = slots_[slot(seed_, path)];
+		if (id != empty and functions_[id].path == path) {
+			return id;
+		}
+		return std::nullopt;
+	}
+
+	// resolves the stages of a pipeline target like /reverse|/echo|/compute,
+	// none if it has fewer than two or one of them is unknown
+	std::optional<std::vector<std::uint32_t>>
+	find_pipeline(std::string_view target) const {
+		if (target.find('|') == std::string_view::npos) {
+			return std::nullopt;
+		}
+		std::vector<std::uint32_t> stages;
+		for (;;) {
+			const auto end = target.find('|');
+			const auto id = find(target.substr(0, end));
+			if (!id) {
+				return std::nullopt;
+			}
+			stages.push_back(*id);
+			if (end == std::string_view::npos) {
+				return stages;
+			}
+			target.remove_prefix(end + 1);
+		}
+	}
+
+	const registered_function& operator[](std::uint32_t id) const {
+		if (id >= functions_.size()) {
+			throw std::runtime_error{"unknown function id"};
+		}
+		return functions_[id];
+	}
+
+	std::size_t size() const { return functions_.size(); }
+
+	// equal on localities that assign the same ids
+	std::uint64_t fingerprint() const { return fingerprint_; }
+
+private:
+	static constexpr std::uint32_t empty = -1;
+
+	std::vector<registered_function> functions_;
+	std::uint64_t fingerprint_ = 14695981039346656037u;
+	std::uint64_t seed_ = 0;
+	std::vector<std::uint32_t> slots_;
+
+	// fnv-1a continuing from state
+	static std::uint64_t hash(std::uint64_t state, std::string_view data) {
+		for (auto c : data) {
+			state = (state ^ static_cast<unsigned char>(c)) * 1099511628211u;
+		}
+		return state;
+	}
+
+	std::size_t slot(std::uint64_t seed, std::string_view path) const {
+		const auto basis = 14695981039346656037u ^ (seed * 0x9e3779b97f4a7c15u);
+		return hash(basis, path) & (slots_.size() - 1);
+	}
+
+	// tries seeds until every path hashes into a slot of its own. with at
+	// least n^2 slots for n paths a seed works with probability above 1/2,
+	// the table stays small for the few functions a runtime serves.
+	void build_slots() {
+		const auto slot_count =
+			std::bit_ceil(functions_.size() * functions_.size() + 1);
+		for (;; ++seed_) {
+			slots_.assign(slot_count, empty);
+			bool collision = false;
+			for (std::uint32_t id = 0; id < functions_.size(); ++id) {
+				auto& entry = slots_[slot(seed_, functions_[id].path)];
+				collision |= entry != empty;
+				entry = id;
+			}
+			if (!collision) {
+				return;
+			}
+		}
+	}
+};
+
+inline const function_registry function_ids;
@@ -4,144 +4,35 @@
   (type (;2;) (func (param i32)))
   (type (;3;) (func))
   (type (;4;) (func (param i32 i32)))
-  (type (;5;) (func (param i32 i32 i32)))
-  (type (;6;) (func (param i32 i32) (result i32)))
-  (type (;7;) (func (param f64 f64) (result f64)))
-  (type (;8;) (func (param i32 i32 f64)))
-  (type (;9;) (func (param f64) (result f64)))
+  (type (;5;) (func (param i32 i32) (result i32)))
+  (type (;6;) (func (param i32 i32 i32 i32 i32 i32 i32)))
+  (type (;7;) (func (param i32 i32 i32 i32)))
+  (import "env" "parallel_for" (func $parallel_for (type 6)))
+  (import "env" "emscripten_notify_memory_growth" (func $emscripten_notify_memory_growth (type 2)))
   (func $__wasm_call_ctors (type 3)
     nop)
   (func $foo_std::__2::span<char__4294967295ul>_ (type 4) (param i32 i32)
-    (local i32 i32 i32 i32 i32 i32 f64 f64 i32 i64 f64 f64 i32)
-    global.get $__stack_pointer
-    i32.const 32
-    i32.sub
-    local.tee 2
-    global.set $__stack_pointer
+    (local i32 i32 i32 i64)
+    i32.const 0
+    i32.const 2000
+    i32.const 2
+    i32.const 0
+    i32.const 0
     i32.const 6000000
     call $dlmalloc
-    local.set 5
-    loop  ;; label = @1
-      local.get 7
-      f64.convert_i32_s
-      local.tee 8
-      local.get 8
-      f64.add
-      f64.const 0x1.f4p+10 (;=2000;)
-      f64.div
-      f64.const -0x1p+0 (;=-1;)
-      f64.add
-      local.set 9
-      i32.const 0
-      local.set 10
-      loop  ;; label = @2
-        local.get 2
-        local.get 9
-        f64.store offset=24
-        local.get 2
-        local.get 10
-        f64.convert_i32_s
-        f64.const 0x1.8p+1 (;=3;)
-        f64.mul
-        f64.const 0x1.77p+11 (;=3000;)
-        f64.div
-        f64.const -0x1p+1 (;=-2;)
-        f64.add
-        local.tee 12
-        f64.store offset=16
-        i32.const 0
-        local.set 3
-        i32.const 0
-        local.set 4
-        block  ;; label = @3
-          local.get 12
-          local.get 9
-          call $hypot
-          f64.const 0x1p+1 (;=2;)
-          f64.gt
-          br_if 0 (;@3;)
-          loop  ;; label = @4
-            local.get 2
-            local.get 2
-            i32.const 16
-            i32.add
-            local.get 2
-            i32.const 16
-            i32.add
-            call $std::__2::complex<double>_std::__2::operator*_abi:v160004_<double>_std::__2::complex<double>_const&__std::__2::complex<double>_const&_
-            local.get 2
-            local.get 9
-            local.get 2
-            f64.load offset=8
-            f64.add
-            local.tee 8
-            f64.store offset=24
-            local.get 2
-            local.get 12
-            local.get 2
-            f64.load
-            f64.add
-            local.tee 13
-            f64.store offset=16
-            local.get 3
-            i32.const 1
-            i32.add
-            local.set 4
-            local.get 13
-            local.get 8
-            call $hypot
-            f64.const 0x1p+1 (;=2;)
-            f64.gt
-            br_if 1 (;@3;)
-            local.get 3
-            i32.const 255
-            i32.and
-            local.set 14
-            local.get 4
-            local.set 3
-            local.get 14
-            i32.const 99
-            i32.lt_u
-            br_if 0 (;@4;)
-          end
-        end
-        local.get 5
-        local.get 6
-        i32.add
-        local.get 4
-        i32.store8
-        local.get 6
-        i32.const 1
-        i32.add
-        local.set 6
-        local.get 10
-        i32.const 1
-        i32.add
-        local.tee 10
-        i32.const 3000
-        i32.ne
-        br_if 0 (;@2;)
-      end
-      local.get 7
-      i32.const 1
-      i32.add
-      local.tee 7
-      i32.const 2000
-      i32.ne
-      br_if 0 (;@1;)
-    end
-    i32.const 0
-    local.set 4
+    local.tee 2
+    i32.const 3000
+    call $parallel_for
     loop  ;; label = @1
-      local.get 5
+      local.get 2
       local.get 4
       i32.const 1
       i32.or
       i32.add
       i64.load8_u
-      local.get 11
-      local.get 4
       local.get 5
+      local.get 2
+      local.get 4
       i32.add
       local.tee 3
       i64.load8_u
@@ -159,7 +50,7 @@
       local.get 3
       i64.load8_u offset=5
       i64.add
-      local.set 11
+      local.set 5
       local.get 4
       i32.const 6
       i32.add
@@ -168,248 +59,132 @@
       i32.ne
       br_if 0 (;@1;)
     end
-    local.get 5
+    local.get 2
     call $dlfree
     i32.const 8
     call $dlmalloc
     local.tee 3
-    local.get 11
+    local.get 5
     i64.store align=1
     local.get 0
     i32.const 8
     i32.store offset=4
     local.get 0
     local.get 3
-    i32.store
-    local.get 2
-    i32.const 32
-    i32.add
-    global.set $__stack_pointer)
-  (func $std::__2::complex<double>_std::__2::operator*_abi:v160004_<double>_std::__2::complex<double>_const&__std::__2::complex<double>_const&_ (type 5) (param i32 i32 i32)
-    (local f64 f64 f64 f64 f64 f64 f64 f64 f64 f64 i32)
-    local.get 1
-    f64.load offset=8
+    i32.store)
+  (func $_anonymous_namespace_::row_body_int__char_const*__unsigned_long__char*_ (type 7) (param i32 i32 i32 i32)
+    (local i32 f64 v128 v128 v128 v128 v128 v128 v128 i32 v128)
+    local.get 0
+    f64.convert_i32_s
     local.tee 5
-    local.get 2
-    f64.load
-    local.tee 3
-    f64.mul
-    local.tee 9
-    local.get 1
-    f64.load
-    local.tee 4
-    local.get 2
-    f64.load offset=8
-    local.tee 6
-    f64.mul
-    local.tee 10
+    local.get 5
+    f64.add
+    f64.const 0x1.f4p+10 (;=2000;)
+    f64.div
+    f64.const -0x1p+0 (;=-1;)
     f64.add
+    f64x2.splat
     local.set 7
-    block  ;; label = @1
+    loop  ;; label = @1
       local.get 4
-      local.get 3
+      f64.convert_i32_s
+      f64.const 0x1.8p+1 (;=3;)
       f64.mul
-      local.tee 11
-      local.get 5
-      local.get 6
+      f64.const 0x1.77p+11 (;=3000;)
+      f64.div
+      f64.const -0x1p+1 (;=-2;)
+      f64.add
+      f64x2.splat
+      local.get 4
+      i32.const 1
+      i32.or
+      f64.convert_i32_s
+      f64.const 0x1.8p+1 (;=3;)
       f64.mul
-      local.tee 12
-      f64.sub
-      local.tee 8
-      local.get 8
-      f64.eq
-      br_if 0 (;@1;)
-      local.get 7
+      f64.const 0x1.77p+11 (;=3000;)
+      f64.div
+      f64.const -0x1p+1 (;=-2;)
+      f64.add
+      f64x2.replace_lane 1
+      local.tee 6
+      local.set 8
       local.get 7
-      f64.eq
-      br_if 0 (;@1;)
-      block  ;; label = @2
-        local.get 4
-        f64.abs
-        f64.const inf (;=inf;)
-        f64.eq
-        local.tee 2
-        local.get 5
-        f64.abs
-        f64.const inf (;=inf;)
-        f64.eq
-        local.tee 1
-        i32.or
-        local.tee 13
-        i32.eqz
-        br_if 0 (;@2;)
-        f64.const 0x1p+0 (;=1;)
-        f64.const 0x0p+0 (;=0;)
-        local.get 2
-        select
-        local.get 4
-        f64.copysign
-        local.set 4
-        f64.const 0x1p+0 (;=1;)
-        f64.const 0x0p+0 (;=0;)
-        f64.const 0x1p+0 (;=1;)
-        local.get 2
-        select
-        local.get 1
-        select
-        local.get 5
-        f64.copysign
-        local.set 5
-        f64.const 0x0p+0 (;=0;)
-        local.get 3
-        f64.copysign
-        local.get 3
-        local.get 3
-        local.get 3
-        f64.ne
-        select
-        local.set 3
-        local.get 6
-        local.get 6
-        f64.eq
-        br_if 0 (;@2;)
-        f64.const 0x0p+0 (;=0;)
-        local.get 6
-        f64.copysign
-        local.set 6
-      end
+      local.set 9
+      v128.const i32x4 0x00000000 0x00000000 0x00000000 0x00000000
+      local.set 10
+      v128.const i32x4 0xffffffff 0xffffffff 0xffffffff 0xffffffff
+      local.set 11
+      i32.const 0
+      local.set 13
       block  ;; label = @2
-        local.get 3
-        f64.abs
-        f64.const inf (;=inf;)
-        f64.eq
-        local.tee 1
-        local.get 6
-        f64.abs
-        f64.const inf (;=inf;)
-        f64.eq
-        local.tee 2
-        i32.or
-        if  ;; label = @3
-          f64.const 0x1p+0 (;=1;)
-          f64.const 0x0p+0 (;=0;)
-          local.get 1
-          select
-          local.get 3
-          f64.copysign
-          local.set 3
-          f64.const 0x1p+0 (;=1;)
-          f64.const 0x0p+0 (;=0;)
-          f64.const 0x1p+0 (;=1;)
-          local.get 1
-          select
-          local.get 2
-          select
-          local.get 6
-          f64.copysign
-          local.set 6
-          f64.const 0x0p+0 (;=0;)
-          local.get 4
-          f64.copysign
-          local.get 4
-          local.get 4
-          local.get 4
-          f64.ne
-          select
-          local.set 4
-          local.get 5
-          local.get 5
-          f64.eq
+        loop  ;; label = @3
+          local.get 11
+          local.get 8
+          local.get 8
+          f64x2.mul
+          local.tee 12
+          local.get 9
+          local.get 9
+          f64x2.mul
+          local.tee 14
+          f64x2.add
+          v128.const i32x4 0x00000000 0x40100000 0x00000000 0x40100000
+          f64x2.le
+          v128.and
+          local.tee 11
+          v128.any_true
+          i32.eqz
           br_if 1 (;@2;)
-          f64.const 0x0p+0 (;=0;)
-          local.get 5
-          f64.copysign
-          local.set 5
-          br 1 (;@2;)
-        end
-        local.get 13
-        br_if 0 (;@2;)
-        block  ;; label = @3
+          local.get 10
           local.get 11
-          f64.abs
-          f64.const inf (;=inf;)
-          f64.eq
-          br_if 0 (;@3;)
+          i64x2.sub
+          local.set 10
+          local.get 8
+          local.get 9
+          f64x2.mul
+          local.get 9
+          local.get 8
+          f64x2.mul
+          f64x2.add
+          local.get 7
+          f64x2.add
+          local.set 9
           local.get 12
-          f64.abs
-          f64.const inf (;=inf;)
-          f64.eq
-          br_if 0 (;@3;)
-          local.get 10
-          f64.abs
-          f64.const inf (;=inf;)
-          f64.eq
+          local.get 14
+          f64x2.sub
+          local.get 6
+          f64x2.add
+          local.set 8
+          local.get 13
+          i32.const 1
+          i32.add
+          local.tee 13
+          i32.const 100
+          i32.ne
           br_if 0 (;@3;)
-          local.get 9
-          f64.abs
-          f64.const inf (;=inf;)
-          f64.ne
-          br_if 2 (;@1;)
         end
-        f64.const 0x0p+0 (;=0;)
-        local.get 3
-        f64.copysign
-        local.get 3
-        local.get 3
-        local.get 3
-        f64.ne
-        select
-        local.set 3
-        f64.const 0x0p+0 (;=0;)
-        local.get 5
-        f64.copysign
-        local.get 5
-        local.get 5
-        local.get 5
-        f64.ne
-        select
-        local.set 5
-        f64.const 0x0p+0 (;=0;)
-        local.get 4
-        f64.copysign
-        local.get 4
-        local.get 4
-        local.get 4
-        f64.ne
-        select
-        local.set 4
-        local.get 6
-        local.get 6
-        f64.eq
-        br_if 0 (;@2;)
-        f64.const 0x0p+0 (;=0;)
-        local.get 6
-        f64.copysign
-        local.set 6
       end
-      local.get 4
-      local.get 6
-      f64.mul
       local.get 3
-      local.get 5
-      f64.mul
-      f64.add
-      f64.const inf (;=inf;)
-      f64.mul
-      local.set 7
-      local.get 4
+      local.get 10
+      i64x2.extract_lane 0
+      i64.store8
       local.get 3
-      f64.mul
-      local.get 6
-      local.get 5
-      f64.mul
-      f64.sub
-      f64.const inf (;=inf;)
-      f64.mul
-      local.set 8
-    end
-    local.get 0
-    local.get 7
-    f64.store offset=8
-    local.get 0
-    local.get 8
-    f64.store)
-  (func $function (type 6) (param i32 i32) (result i32)
+      local.get 10
+      i64x2.extract_lane 1
+      i64.store8 offset=1
+      local.get 3
+      i32.const 2
+      i32.add
+      local.set 3
+      local.get 4
+      i32.const 2
+      i32.add
+      local.tee 4
+      i32.const 3000
+      i32.ne
+      br_if 0 (;@1;)
+    end)
+  (func $function (type 5) (param i32 i32) (result i32)
     (local i32 i32)
     global.get $__stack_pointer
     i32.const 32
@@ -450,184 +225,6 @@
     call $dlfree)
   (func $_initialize (type 3)
     call $__wasm_call_ctors)
-  (func $hypot (type 7) (param f64 f64) (result f64)
-    (local i32 i64 i64 i64 i32 i32 f64)
-    global.get $__stack_pointer
-    i32.const 32
-    i32.sub
-    local.tee 2
-    global.set $__stack_pointer
-    local.get 0
-    i64.reinterpret_f64
-    i64.const 9223372036854775807
-    i64.and
-    local.tee 3
-    local.get 1
-    i64.reinterpret_f64
-    i64.const 9223372036854775807
-    i64.and
-    local.tee 4
-    local.get 3
-    local.get 4
-    i64.lt_u
-    select
-    local.tee 5
-    f64.reinterpret_i64
-    local.set 1
-    block  ;; label = @1
-      local.get 5
-      i64.const 52
-      i64.shr_u
-      i32.wrap_i64
-      local.tee 6
-      i32.const 2047
-      i32.eq
-      br_if 0 (;@1;)
-      local.get 3
-      local.get 4
-      local.get 3
-      local.get 4
-      i64.gt_u
-      select
-      local.tee 3
-      f64.reinterpret_i64
-      local.set 0
-      block  ;; label = @2
-        local.get 5
-        i64.eqz
-        br_if 0 (;@2;)
-        local.get 3
-        i64.const 52
-        i64.shr_u
-        i32.wrap_i64
-        local.tee 7
-        i32.const 2047
-        i32.eq
-        br_if 0 (;@2;)
-        local.get 7
-        local.get 6
-        i32.sub
-        i32.const 65
-        i32.ge_s
-        if  ;; label = @3
-          local.get 0
-          local.get 1
-          f64.add
-          local.set 1
-          br 2 (;@1;)
-        end
-        block (result f64)  ;; label = @3
-          local.get 7
-          i32.const 1534
-          i32.ge_u
-          if  ;; label = @4
-            local.get 1
-            f64.const 0x1p-700 (;=1.90109e-211;)
-            f64.mul
-            local.set 1
-            local.get 0
-            f64.const 0x1p-700 (;=1.90109e-211;)
-            f64.mul
-            local.set 0
-            f64.const 0x1p+700 (;=5.26014e+210;)
-            br 1 (;@3;)
-          end
-          f64.const 0x1p+0 (;=1;)
-          local.tee 8
-          local.get 6
-          i32.const 572
-          i32.gt_u
-          br_if 0 (;@3;)
-          drop
-          local.get 1
-          f64.const 0x1p+700 (;=5.26014e+210;)
-          f64.mul
-          local.set 1
-          local.get 0
-          f64.const 0x1p+700 (;=5.26014e+210;)
-          f64.mul
-          local.set 0
-          f64.const 0x1p-700 (;=1.90109e-211;)
-        end
-        local.set 8
-        local.get 2
-        i32.const 24
-        i32.add
-        local.get 2
-        i32.const 16
-        i32.add
-        local.get 0
-        call $sq
-        local.get 2
-        i32.const 8
-        i32.add
-        local.get 2
-        local.get 1
-        call $sq
-        local.get 8
-        local.get 2
-        f64.load
-        local.get 2
-        f64.load offset=16
-        f64.add
-        local.get 2
-        f64.load offset=8
-        f64.add
-        local.get 2
-        f64.load offset=24
-        f64.add
-        call $sqrt
-        f64.mul
-        local.set 1
-        br 1 (;@1;)
-      end
-      local.get 0
-      local.set 1
-    end
-    local.get 2
-    i32.const 32
-    i32.add
-    global.set $__stack_pointer
-    local.get 1)
-  (func $sq (type 8) (param i32 i32 f64)
-    (local f64 f64)
-    local.get 0
-    local.get 2
-    local.get 2
-    f64.mul
-    local.tee 4
-    f64.store
-    local.get 1
-    local.get 2
-    local.get 2
-    f64.const 0x1.0000002p+27 (;=1.34218e+08;)
-    f64.mul
-    local.tee 3
-    local.get 2
-    local.get 3
-    f64.sub
-    f64.add
-    local.tee 3
-    f64.sub
-    local.tee 2
-    local.get 2
-    f64.mul
-    local.get 3
-    local.get 3
-    f64.add
-    local.get 2
-    f64.mul
-    local.get 3
-    local.get 3
-    f64.mul
-    local.get 4
-    f64.sub
-    f64.add
-    f64.add
-    f64.store)
-  (func $sqrt (type 9) (param f64) (result f64)
-    local.get 0
-    f64.sqrt)
   (func $emscripten_get_heap_size (type 1) (result i32)
     memory.size
     i32.const 16
@@ -635,6 +232,25 @@
   (func $__errno_location (type 1) (result i32)
     i32.const 1032)
   (func $emscripten_resize_heap (type 0) (param i32) (result i32)
+    block  ;; label = @1
+      local.get 0
+      memory.size
+      i32.const 16
+      i32.shl
+      i32.sub
+      i32.const 65535
+      i32.add
+      i32.const 16
+      i32.shr_u
+      memory.grow
+      i32.const -1
+      i32.eq
+      br_if 0 (;@1;)
+      i32.const 0
+      call $emscripten_notify_memory_growth
+      i32.const 1
+      return
+    end
     i32.const 0)
   (func $sbrk (type 0) (param i32) (result i32)
     (local i32 i32)
@@ -4054,8 +3670,8 @@
     local.tee 1
     global.set $__stack_pointer
     local.get 1)
-  (table (;0;) 2 2 funcref)
-  (memory (;0;) 32768 32768)
+  (table (;0;) 3 3 funcref)
+  (memory (;0;) 256 32768)
   (global $__stack_pointer (mut i32) (i32.const 67072))
   (export "memory" (memory 0))
   (export "function" (func $function))
@@ -4063,10 +3679,9 @@
   (export "alloc" (func $alloc))
   (export "dealloc" (func $dealloc))
   (export "__indirect_function_table" (table 0))
-  (export "_initialize" (func $_initialize))
   (export "__errno_location" (func $__errno_location))
   (export "stackSave" (func $stackSave))
   (export "stackRestore" (func $stackRestore))
   (export "stackAlloc" (func $stackAlloc))
-  (elem (;0;) (i32.const 1) func $__wasm_call_ctors)
+  (elem (;0;) (i32.const 1) func $__wasm_call_ctors $_anonymous_namespace_::row_body_int__char_const*__unsigned_long__char*_)
   (data $.data (i32.const 1025) "\06\01"))
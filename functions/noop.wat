@@ -4,6 +4,7 @@
   (type (;2;) (func (param i32)))
   (type (;3;) (func))
   (type (;4;) (func (param i32 i32) (result i32)))
+  (import "env" "emscripten_notify_memory_growth" (func $emscripten_notify_memory_growth (type 2)))
   (func $__wasm_call_ctors (type 3)
     nop)
   (func $function (type 4) (param i32 i32) (result i32)
@@ -29,6 +30,25 @@
   (func $__errno_location (type 1) (result i32)
     i32.const 1032)
   (func $emscripten_resize_heap (type 0) (param i32) (result i32)
+    block  ;; label = @1
+      local.get 0
+      memory.size
+      i32.const 16
+      i32.shl
+      i32.sub
+      i32.const 65535
+      i32.add
+      i32.const 16
+      i32.shr_u
+      memory.grow
+      i32.const -1
+      i32.eq
+      br_if 0 (;@1;)
+      i32.const 0
+      call $emscripten_notify_memory_growth
+      i32.const 1
+      return
+    end
     i32.const 0)
   (func $sbrk (type 0) (param i32) (result i32)
     (local i32 i32)
@@ -3449,7 +3469,7 @@
     global.set $__stack_pointer
     local.get 1)
   (table (;0;) 2 2 funcref)
-  (memory (;0;) 32768 32768)
+  (memory (;0;) 256 32768)
   (global $__stack_pointer (mut i32) (i32.const 67072))
   (export "memory" (memory 0))
   (export "function" (func $function))
@@ -3457,7 +3477,6 @@
   (export "alloc" (func $alloc))
   (export "dealloc" (func $dealloc))
   (export "__indirect_function_table" (table 0))
-  (export "_initialize" (func $_initialize))
   (export "__errno_location" (func $__errno_location))
   (export "stackSave" (func $stackSave))
   (export "stackRestore" (func $stackRestore))
@@ -4,44 +4,83 @@
   (type (;2;) (func (param i32)))
   (type (;3;) (func))
   (type (;4;) (func (param i32 i32) (result i32)))
+  (import "env" "emscripten_notify_memory_growth" (func $emscripten_notify_memory_growth (type 2)))
   (func $__wasm_call_ctors (type 3)
     nop)
   (func $function (type 4) (param i32 i32) (result i32)
-    (local i32 i32 i32)
+    (local i32 i32 v128 v128 i32)
+    local.get 0
+    local.get 1
+    i32.add
+    local.set 3
+    local.get 0
+    local.set 2
     block  ;; label = @1
       local.get 1
-      i32.eqz
+      i32.const 32
+      i32.lt_s
       br_if 0 (;@1;)
-      local.get 0
-      local.get 1
-      i32.add
+      loop  ;; label = @2
+        local.get 2
+        v128.load align=1
+        local.set 4
+        local.get 2
+        local.get 3
+        i32.const 16
+        i32.sub
+        local.tee 3
+        v128.load align=1
+        local.tee 5
+        local.get 5
+        i8x16.shuffle 15 14 13 12 11 10 9 8 7 6 5 4 3 2 1 0
+        v128.store align=1
+        local.get 3
+        local.get 4
+        local.get 4
+        i8x16.shuffle 15 14 13 12 11 10 9 8 7 6 5 4 3 2 1 0
+        v128.store align=1
+        local.get 3
+        local.get 2
+        i32.const 16
+        i32.add
+        local.tee 2
+        i32.sub
+        i32.const 31
+        i32.gt_s
+        br_if 0 (;@2;)
+      end
+    end
+    block  ;; label = @1
+      local.get 2
+      local.get 3
+      i32.eq
+      br_if 0 (;@1;)
+      local.get 2
+      local.get 3
       i32.const 1
       i32.sub
-      local.tee 2
-      local.get 0
-      i32.le_u
+      local.tee 3
+      i32.ge_u
       br_if 0 (;@1;)
-      local.get 0
-      local.set 3
       loop  ;; label = @2
-        local.get 3
-        i32.load8_u
-        local.set 4
-        local.get 3
         local.get 2
         i32.load8_u
-        i32.store8
+        local.set 6
         local.get 2
-        local.get 4
+        local.get 3
+        i32.load8_u
         i32.store8
         local.get 3
+        local.get 6
+        i32.store8
+        local.get 2
         i32.const 1
         i32.add
-        local.tee 3
-        local.get 2
+        local.tee 2
+        local.get 3
         i32.const 1
         i32.sub
-        local.tee 2
+        local.tee 3
         i32.lt_u
         br_if 0 (;@2;)
       end
@@ -68,6 +107,25 @@
   (func $__errno_location (type 1) (result i32)
     i32.const 1032)
   (func $emscripten_resize_heap (type 0) (param i32) (result i32)
+    block  ;; label = @1
+      local.get 0
+      memory.size
+      i32.const 16
+      i32.shl
+      i32.sub
+      i32.const 65535
+      i32.add
+      i32.const 16
+      i32.shr_u
+      memory.grow
+      i32.const -1
+      i32.eq
+      br_if 0 (;@1;)
+      i32.const 0
+      call $emscripten_notify_memory_growth
+      i32.const 1
+      return
+    end
     i32.const 0)
   (func $sbrk (type 0) (param i32) (result i32)
     (local i32 i32)
@@ -3488,7 +3546,7 @@
     global.set $__stack_pointer
     local.get 1)
   (table (;0;) 2 2 funcref)
-  (memory (;0;) 32768 32768)
+  (memory (;0;) 256 32768)
   (global $__stack_pointer (mut i32) (i32.const 67072))
   (export "memory" (memory 0))
   (export "function" (func $function))
@@ -3496,7 +3554,6 @@
   (export "alloc" (func $alloc))
   (export "dealloc" (func $dealloc))
   (export "__indirect_function_table" (table 0))
-  (export "_initialize" (func $_initialize))
   (export "__errno_location" (func $__errno_location))
   (export "stackSave" (func $stackSave))
   (export "stackRestore" (func $stackRestore))
@@ -0,0 +1,2861 @@
+;; maintained by hand, not generated: functions_impl/streaming.cpp with the
+;; asyncify ABI that wasm_function_io in streaming_http_hpx.cpp drives.
+;; asyncify_start_unwind/asyncify_start_rewind take the address of [cur, end],
+;; the bounds of the buffer the stack is unwound into. $function is the only
+;; function that can unwind. it pushes one i32 there, the index of the import
+;; call that unwound it (0 for more, 1 for get_byte), and on rewind pops it and
+;; skips ahead to that call. no locals are live across either call. a change to
+;; streaming.cpp has to be carried over here by hand.
+(module
+  (type (;0;) (func (param i32) (result i32)))
+  (type (;1;) (func (result i32)))
+  (type (;2;) (func (param i32)))
+  (type (;3;) (func))
+  (import "env" "more" (func $more (type 1)))
+  (import "env" "get_byte" (func $get_byte (type 1)))
+  (import "env" "put_byte" (func $put_byte (type 2)))
+  (import "env" "emscripten_notify_memory_growth" (func $emscripten_notify_memory_growth (type 2)))
+  (func $__wasm_call_ctors (type 3)
+    nop)
+  (func $function (type 3)
+    (local i32 i32)
+    global.get $__asyncify_state
+    i32.const 2
+    i32.eq
+    if  ;; label = @1
+      global.get $__asyncify_data
+      global.get $__asyncify_data
+      i32.load
+      i32.const 4
+      i32.sub
+      local.tee 0
+      i32.store
+      local.get 0
+      i32.load
+      local.set 0
+    end
+    block  ;; label = @1
+      loop  ;; label = @2
+        block  ;; label = @3
+          global.get $__asyncify_state
+          i32.const 2
+          i32.eq
+          local.get 0
+          i32.const 1
+          i32.eq
+          i32.and
+          br_if 0 (;@3;)
+          call $more
+          local.set 1
+          global.get $__asyncify_state
+          i32.const 1
+          i32.eq
+          if  ;; label = @4
+            i32.const 0
+            call $__asyncify_save_call_index
+            br 3 (;@1;)
+          end
+          local.get 1
+          i32.eqz
+          br_if 2 (;@1;)
+        end
+        call $get_byte
+        local.set 1
+        global.get $__asyncify_state
+        i32.const 1
+        i32.eq
+        if  ;; label = @3
+          i32.const 1
+          call $__asyncify_save_call_index
+          br 2 (;@1;)
+        end
+        local.get 1
+        call $put_byte
+        br 0 (;@2;)
+      end
+    end)
+  (func $__asyncify_save_call_index (type 2) (param i32)
+    (local i32)
+    global.get $__asyncify_data
+    i32.load
+    local.tee 1
+    i32.const 4
+    i32.add
+    global.get $__asyncify_data
+    i32.load offset=4
+    i32.gt_u
+    if  ;; label = @1
+      unreachable
+    end
+    local.get 1
+    local.get 0
+    i32.store
+    global.get $__asyncify_data
+    local.get 1
+    i32.const 4
+    i32.add
+    i32.store)
+  (func $alloc (type 0) (param i32) (result i32)
+    local.get 0
+    call $dlmalloc)
+  (func $_initialize (type 3)
+    call $__wasm_call_ctors)
+  (func $emscripten_get_heap_size (type 1) (result i32)
+    memory.size
+    i32.const 16
+    i32.shl)
+  (func $__errno_location (type 1) (result i32)
+    i32.const 1032)
+  (func $emscripten_resize_heap (type 0) (param i32) (result i32)
+    block  ;; label = @1
+      local.get 0
+      memory.size
+      i32.const 16
+      i32.shl
+      i32.sub
+      i32.const 65535
+      i32.add
+      i32.const 16
+      i32.shr_u
+      memory.grow
+      i32.const -1
+      i32.eq
+      br_if 0 (;@1;)
+      i32.const 0
+      call $emscripten_notify_memory_growth
+      i32.const 1
+      return
+    end
+    i32.const 0)
+  (func $sbrk (type 0) (param i32) (result i32)
+    (local i32 i32)
+    i32.const 1024
+    i32.load
+    local.tee 1
+    local.get 0
+    i32.const 7
+    i32.add
+    i32.const -8
+    i32.and
+    local.tee 2
+    i32.add
+    local.set 0
+    block  ;; label = @1
+      local.get 2
+      i32.const 0
+      local.get 0
+      local.get 1
+      i32.le_u
+      select
+      br_if 0 (;@1;)
+      call $emscripten_get_heap_size
+      local.get 0
+      i32.lt_u
+      if  ;; label = @2
+        local.get 0
+        call $emscripten_resize_heap
+        i32.eqz
+        br_if 1 (;@1;)
+      end
+      i32.const 1024
+      local.get 0
+      i32.store
+      local.get 1
+      return
+    end
+    call $__errno_location
+    i32.const 48
+    i32.store
+    i32.const -1)
+  (func $dlmalloc (type 0) (param i32) (result i32)
+    (local i32 i32 i32 i32 i32 i32 i32 i32 i32 i32 i32)
+    global.get $__stack_pointer
+    i32.const 16
+    i32.sub
+    local.tee 10
+    global.set $__stack_pointer
+    block  ;; label = @1
+      block  ;; label = @2
+        block  ;; label = @3
+          block  ;; label = @4
+            block  ;; label = @5
+              block  ;; label = @6
+                block  ;; label = @7
+                  block  ;; label = @8
+                    block  ;; label = @9
+                      block  ;; label = @10
+                        block  ;; label = @11
+                          block  ;; label = @12
+                            block  ;; label = @13
+                              block  ;; label = @14
+                                local.get 0
+                                i32.const 244
+                                i32.le_u
+                                if  ;; label = @15
+                                  i32.const 1036
+                                  i32.load
+                                  local.tee 6
+                                  i32.const 16
+                                  local.get 0
+                                  i32.const 11
+                                  i32.add
+                                  i32.const -8
+                                  i32.and
+                                  local.get 0
+                                  i32.const 11
+                                  i32.lt_u
+                                  select
+                                  local.tee 5
+                                  i32.const 3
+                                  i32.shr_u
+                                  local.tee 1
+                                  i32.shr_u
+                                  local.tee 0
+                                  i32.const 3
+                                  i32.and
+                                  if  ;; label = @16
+                                    block  ;; label = @17
+                                      local.get 0
+                                      i32.const -1
+                                      i32.xor
+                                      i32.const 1
+                                      i32.and
+                                      local.get 1
+                                      i32.add
+                                      local.tee 3
+                                      i32.const 3
+                                      i32.shl
+                                      local.tee 1
+                                      i32.const 1076
+                                      i32.add
+                                      local.tee 0
+                                      local.get 1
+                                      i32.const 1084
+                                      i32.add
+                                      i32.load
+                                      local.tee 1
+                                      i32.load offset=8
+                                      local.tee 5
+                                      i32.eq
+                                      if  ;; label = @18
+                                        i32.const 1036
+                                        local.get 6
+                                        i32.const -2
+                                        local.get 3
+                                        i32.rotl
+                                        i32.and
+                                        i32.store
+                                        br 1 (;@17;)
+                                      end
+                                      local.get 5
+                                      local.get 0
+                                      i32.store offset=12
+                                      local.get 0
+                                      local.get 5
+                                      i32.store offset=8
+                                    end
+                                    local.get 1
+                                    i32.const 8
+                                    i32.add
+                                    local.set 0
+                                    local.get 1
+                                    local.get 3
+                                    i32.const 3
+                                    i32.shl
+                                    local.tee 3
+                                    i32.const 3
+                                    i32.or
+                                    i32.store offset=4
+                                    local.get 1
+                                    local.get 3
+                                    i32.add
+                                    local.tee 1
+                                    local.get 1
+                                    i32.load offset=4
+                                    i32.const 1
+                                    i32.or
+                                    i32.store offset=4
+                                    br 15 (;@1;)
+                                  end
+                                  local.get 5
+                                  i32.const 1044
+                                  i32.load
+                                  local.tee 8
+                                  i32.le_u
+                                  br_if 1 (;@14;)
+                                  local.get 0
+                                  if  ;; label = @16
+                                    block  ;; label = @17
+                                      local.get 0
+                                      local.get 1
+                                      i32.shl
+                                      i32.const 2
+                                      local.get 1
+                                      i32.shl
+                                      local.tee 0
+                                      i32.const 0
+                                      local.get 0
+                                      i32.sub
+                                      i32.or
+                                      i32.and
+                                      i32.ctz
+                                      local.tee 1
+                                      i32.const 3
+                                      i32.shl
+                                      local.tee 0
+                                      i32.const 1076
+                                      i32.add
+                                      local.tee 3
+                                      local.get 0
+                                      i32.const 1084
+                                      i32.add
+                                      i32.load
+                                      local.tee 0
+                                      i32.load offset=8
+                                      local.tee 2
+                                      i32.eq
+                                      if  ;; label = @18
+                                        i32.const 1036
+                                        local.get 6
+                                        i32.const -2
+                                        local.get 1
+                                        i32.rotl
+                                        i32.and
+                                        local.tee 6
+                                        i32.store
+                                        br 1 (;@17;)
+                                      end
+                                      local.get 2
+                                      local.get 3
+                                      i32.store offset=12
+                                      local.get 3
+                                      local.get 2
+                                      i32.store offset=8
+                                    end
+                                    local.get 0
+                                    local.get 5
+                                    i32.const 3
+                                    i32.or
+                                    i32.store offset=4
+                                    local.get 0
+                                    local.get 5
+                                    i32.add
+                                    local.tee 2
+                                    local.get 1
+                                    i32.const 3
+                                    i32.shl
+                                    local.tee 1
+                                    local.get 5
+                                    i32.sub
+                                    local.tee 3
+                                    i32.const 1
+                                    i32.or
+                                    i32.store offset=4
+                                    local.get 0
+                                    local.get 1
+                                    i32.add
+                                    local.get 3
+                                    i32.store
+                                    local.get 8
+                                    if  ;; label = @17
+                                      local.get 8
+                                      i32.const -8
+                                      i32.and
+                                      i32.const 1076
+                                      i32.add
+                                      local.set 5
+                                      i32.const 1056
+                                      i32.load
+                                      local.set 1
+                                      block (result i32)  ;; label = @18
+                                        local.get 6
+                                        i32.const 1
+                                        local.get 8
+                                        i32.const 3
+                                        i32.shr_u
+                                        i32.shl
+                                        local.tee 4
+                                        i32.and
+                                        i32.eqz
+                                        if  ;; label = @19
+                                          i32.const 1036
+                                          local.get 4
+                                          local.get 6
+                                          i32.or
+                                          i32.store
+                                          local.get 5
+                                          br 1 (;@18;)
+                                        end
+                                        local.get 5
+                                        i32.load offset=8
+                                      end
+                                      local.set 4
+                                      local.get 5
+                                      local.get 1
+                                      i32.store offset=8
+                                      local.get 4
+                                      local.get 1
+                                      i32.store offset=12
+                                      local.get 1
+                                      local.get 5
+                                      i32.store offset=12
+                                      local.get 1
+                                      local.get 4
+                                      i32.store offset=8
+                                    end
+                                    local.get 0
+                                    i32.const 8
+                                    i32.add
+                                    local.set 0
+                                    i32.const 1056
+                                    local.get 2
+                                    i32.store
+                                    i32.const 1044
+                                    local.get 3
+                                    i32.store
+                                    br 15 (;@1;)
+                                  end
+                                  i32.const 1040
+                                  i32.load
+                                  local.tee 11
+                                  i32.eqz
+                                  br_if 1 (;@14;)
+                                  local.get 11
+                                  i32.ctz
+                                  i32.const 2
+                                  i32.shl
+                                  i32.const 1340
+                                  i32.add
+                                  i32.load
+                                  local.tee 2
+                                  i32.load offset=4
+                                  i32.const -8
+                                  i32.and
+                                  local.get 5
+                                  i32.sub
+                                  local.set 1
+                                  local.get 2
+                                  local.set 3
+                                  loop  ;; label = @16
+                                    block  ;; label = @17
+                                      local.get 3
+                                      i32.load offset=16
+                                      local.tee 0
+                                      i32.eqz
+                                      if  ;; label = @18
+                                        local.get 3
+                                        i32.load offset=20
+                                        local.tee 0
+                                        i32.eqz
+                                        br_if 1 (;@17;)
+                                      end
+                                      local.get 0
+                                      i32.load offset=4
+                                      i32.const -8
+                                      i32.and
+                                      local.get 5
+                                      i32.sub
+                                      local.tee 3
+                                      local.get 1
+                                      local.get 1
+                                      local.get 3
+                                      i32.gt_u
+                                      local.tee 3
+                                      select
+                                      local.set 1
+                                      local.get 0
+                                      local.get 2
+                                      local.get 3
+                                      select
+                                      local.set 2
+                                      local.get 0
+                                      local.set 3
+                                      br 1 (;@16;)
+                                    end
+                                  end
+                                  local.get 2
+                                  i32.load offset=24
+                                  local.set 9
+                                  local.get 2
+                                  local.get 2
+                                  i32.load offset=12
+                                  local.tee 4
+                                  i32.ne
+                                  if  ;; label = @16
+                                    i32.const 1052
+                                    i32.load
+                                    drop
+                                    local.get 2
+                                    i32.load offset=8
+                                    local.tee 0
+                                    local.get 4
+                                    i32.store offset=12
+                                    local.get 4
+                                    local.get 0
+                                    i32.store offset=8
+                                    br 14 (;@2;)
+                                  end
+                                  local.get 2
+                                  i32.const 20
+                                  i32.add
+                                  local.tee 3
+                                  i32.load
+                                  local.tee 0
+                                  i32.eqz
+                                  if  ;; label = @16
+                                    local.get 2
+                                    i32.load offset=16
+                                    local.tee 0
+                                    i32.eqz
+                                    br_if 3 (;@13;)
+                                    local.get 2
+                                    i32.const 16
+                                    i32.add
+                                    local.set 3
+                                  end
+                                  loop  ;; label = @16
+                                    local.get 3
+                                    local.set 7
+                                    local.get 0
+                                    local.tee 4
+                                    i32.const 20
+                                    i32.add
+                                    local.tee 3
+                                    i32.load
+                                    local.tee 0
+                                    br_if 0 (;@16;)
+                                    local.get 4
+                                    i32.const 16
+                                    i32.add
+                                    local.set 3
+                                    local.get 4
+                                    i32.load offset=16
+                                    local.tee 0
+                                    br_if 0 (;@16;)
+                                  end
+                                  local.get 7
+                                  i32.const 0
+                                  i32.store
+                                  br 13 (;@2;)
+                                end
+                                i32.const -1
+                                local.set 5
+                                local.get 0
+                                i32.const -65
+                                i32.gt_u
+                                br_if 0 (;@14;)
+                                local.get 0
+                                i32.const 11
+                                i32.add
+                                local.tee 0
+                                i32.const -8
+                                i32.and
+                                local.set 5
+                                i32.const 1040
+                                i32.load
+                                local.tee 8
+                                i32.eqz
+                                br_if 0 (;@14;)
+                                i32.const 0
+                                local.get 5
+                                i32.sub
+                                local.set 1
+                                block  ;; label = @15
+                                  block  ;; label = @16
+                                    block  ;; label = @17
+                                      block (result i32)  ;; label = @18
+                                        i32.const 0
+                                        local.get 5
+                                        i32.const 256
+                                        i32.lt_u
+                                        br_if 0 (;@18;)
+                                        drop
+                                        i32.const 31
+                                        local.tee 7
+                                        local.get 5
+                                        i32.const 16777215
+                                        i32.gt_u
+                                        br_if 0 (;@18;)
+                                        drop
+                                        local.get 5
+                                        i32.const 38
+                                        local.get 0
+                                        i32.const 8
+                                        i32.shr_u
+                                        i32.clz
+                                        local.tee 0
+                                        i32.sub
+                                        i32.shr_u
+                                        i32.const 1
+                                        i32.and
+                                        local.get 0
+                                        i32.const 1
+                                        i32.shl
+                                        i32.sub
+                                        i32.const 62
+                                        i32.add
+                                      end
+                                      local.tee 7
+                                      i32.const 2
+                                      i32.shl
+                                      i32.const 1340
+                                      i32.add
+                                      i32.load
+                                      local.tee 3
+                                      i32.eqz
+                                      if  ;; label = @18
+                                        i32.const 0
+                                        local.set 0
+                                        br 1 (;@17;)
+                                      end
+                                      i32.const 0
+                                      local.set 0
+                                      local.get 5
+                                      i32.const 25
+                                      local.get 7
+                                      i32.const 1
+                                      i32.shr_u
+                                      i32.sub
+                                      i32.const 0
+                                      local.get 7
+                                      i32.const 31
+                                      i32.ne
+                                      select
+                                      i32.shl
+                                      local.set 2
+                                      loop  ;; label = @18
+                                        block  ;; label = @19
+                                          local.get 3
+                                          i32.load offset=4
+                                          i32.const -8
+                                          i32.and
+                                          local.get 5
+                                          i32.sub
+                                          local.tee 6
+                                          local.get 1
+                                          i32.ge_u
+                                          br_if 0 (;@19;)
+                                          local.get 3
+                                          local.set 4
+                                          local.get 6
+                                          local.tee 1
+                                          br_if 0 (;@19;)
+                                          i32.const 0
+                                          local.set 1
+                                          local.get 3
+                                          local.set 0
+                                          br 3 (;@16;)
+                                        end
+                                        local.get 0
+                                        local.get 3
+                                        i32.load offset=20
+                                        local.tee 6
+                                        local.get 6
+                                        local.get 3
+                                        local.get 2
+                                        i32.const 29
+                                        i32.shr_u
+                                        i32.const 4
+                                        i32.and
+                                        i32.add
+                                        i32.load offset=16
+                                        local.tee 3
+                                        i32.eq
+                                        select
+                                        local.get 0
+                                        local.get 6
+                                        select
+                                        local.set 0
+                                        local.get 2
+                                        i32.const 1
+                                        i32.shl
+                                        local.set 2
+                                        local.get 3
+                                        br_if 0 (;@18;)
+                                      end
+                                    end
+                                    local.get 0
+                                    local.get 4
+                                    i32.or
+                                    i32.eqz
+                                    if  ;; label = @17
+                                      i32.const 0
+                                      local.set 4
+                                      i32.const 2
+                                      local.get 7
+                                      i32.shl
+                                      local.tee 0
+                                      i32.const 0
+                                      local.get 0
+                                      i32.sub
+                                      i32.or
+                                      local.get 8
+                                      i32.and
+                                      local.tee 0
+                                      i32.eqz
+                                      br_if 3 (;@14;)
+                                      local.get 0
+                                      i32.ctz
+                                      i32.const 2
+                                      i32.shl
+                                      i32.const 1340
+                                      i32.add
+                                      i32.load
+                                      local.set 0
+                                    end
+                                    local.get 0
+                                    i32.eqz
+                                    br_if 1 (;@15;)
+                                  end
+                                  loop  ;; label = @16
+                                    local.get 0
+                                    i32.load offset=4
+                                    i32.const -8
+                                    i32.and
+                                    local.get 5
+                                    i32.sub
+                                    local.tee 6
+                                    local.get 1
+                                    i32.lt_u
+                                    local.set 2
+                                    local.get 6
+                                    local.get 1
+                                    local.get 2
+                                    select
+                                    local.set 1
+                                    local.get 0
+                                    local.get 4
+                                    local.get 2
+                                    select
+                                    local.set 4
+                                    local.get 0
+                                    i32.load offset=16
+                                    local.tee 3
+                                    i32.eqz
+                                    if  ;; label = @17
+                                      local.get 0
+                                      i32.load offset=20
+                                      local.set 3
+                                    end
+                                    local.get 3
+                                    local.tee 0
+                                    br_if 0 (;@16;)
+                                  end
+                                end
+                                local.get 4
+                                i32.eqz
+                                br_if 0 (;@14;)
+                                local.get 1
+                                i32.const 1044
+                                i32.load
+                                local.get 5
+                                i32.sub
+                                i32.ge_u
+                                br_if 0 (;@14;)
+                                local.get 4
+                                i32.load offset=24
+                                local.set 7
+                                local.get 4
+                                local.get 4
+                                i32.load offset=12
+                                local.tee 2
+                                i32.ne
+                                if  ;; label = @15
+                                  i32.const 1052
+                                  i32.load
+                                  drop
+                                  local.get 4
+                                  i32.load offset=8
+                                  local.tee 0
+                                  local.get 2
+                                  i32.store offset=12
+                                  local.get 2
+                                  local.get 0
+                                  i32.store offset=8
+                                  br 12 (;@3;)
+                                end
+                                local.get 4
+                                i32.const 20
+                                i32.add
+                                local.tee 3
+                                i32.load
+                                local.tee 0
+                                i32.eqz
+                                if  ;; label = @15
+                                  local.get 4
+                                  i32.load offset=16
+                                  local.tee 0
+                                  i32.eqz
+                                  br_if 3 (;@12;)
+                                  local.get 4
+                                  i32.const 16
+                                  i32.add
+                                  local.set 3
+                                end
+                                loop  ;; label = @15
+                                  local.get 3
+                                  local.set 6
+                                  local.get 0
+                                  local.tee 2
+                                  i32.const 20
+                                  i32.add
+                                  local.tee 3
+                                  i32.load
+                                  local.tee 0
+                                  br_if 0 (;@15;)
+                                  local.get 2
+                                  i32.const 16
+                                  i32.add
+                                  local.set 3
+                                  local.get 2
+                                  i32.load offset=16
+                                  local.tee 0
+                                  br_if 0 (;@15;)
+                                end
+                                local.get 6
+                                i32.const 0
+                                i32.store
+                                br 11 (;@3;)
+                              end
+                              local.get 5
+                              i32.const 1044
+                              i32.load
+                              local.tee 0
+                              i32.le_u
+                              if  ;; label = @14
+                                i32.const 1056
+                                i32.load
+                                local.set 1
+                                block  ;; label = @15
+                                  local.get 0
+                                  local.get 5
+                                  i32.sub
+                                  local.tee 3
+                                  i32.const 16
+                                  i32.ge_u
+                                  if  ;; label = @16
+                                    local.get 1
+                                    local.get 5
+                                    i32.add
+                                    local.tee 2
+                                    local.get 3
+                                    i32.const 1
+                                    i32.or
+                                    i32.store offset=4
+                                    local.get 0
+                                    local.get 1
+                                    i32.add
+                                    local.get 3
+                                    i32.store
+                                    local.get 1
+                                    local.get 5
+                                    i32.const 3
+                                    i32.or
+                                    i32.store offset=4
+                                    br 1 (;@15;)
+                                  end
+                                  local.get 1
+                                  local.get 0
+                                  i32.const 3
+                                  i32.or
+                                  i32.store offset=4
+                                  local.get 0
+                                  local.get 1
+                                  i32.add
+                                  local.tee 0
+                                  local.get 0
+                                  i32.load offset=4
+                                  i32.const 1
+                                  i32.or
+                                  i32.store offset=4
+                                  i32.const 0
+                                  local.set 2
+                                  i32.const 0
+                                  local.set 3
+                                end
+                                i32.const 1044
+                                local.get 3
+                                i32.store
+                                i32.const 1056
+                                local.get 2
+                                i32.store
+                                local.get 1
+                                i32.const 8
+                                i32.add
+                                local.set 0
+                                br 13 (;@1;)
+                              end
+                              local.get 5
+                              i32.const 1048
+                              i32.load
+                              local.tee 2
+                              i32.lt_u
+                              if  ;; label = @14
+                                i32.const 1048
+                                local.get 2
+                                local.get 5
+                                i32.sub
+                                local.tee 1
+                                i32.store
+                                i32.const 1060
+                                i32.const 1060
+                                i32.load
+                                local.tee 0
+                                local.get 5
+                                i32.add
+                                local.tee 3
+                                i32.store
+                                local.get 3
+                                local.get 1
+                                i32.const 1
+                                i32.or
+                                i32.store offset=4
+                                local.get 0
+                                local.get 5
+                                i32.const 3
+                                i32.or
+                                i32.store offset=4
+                                local.get 0
+                                i32.const 8
+                                i32.add
+                                local.set 0
+                                br 13 (;@1;)
+                              end
+                              i32.const 0
+                              local.set 0
+                              local.get 5
+                              i32.const 47
+                              i32.add
+                              local.tee 8
+                              block (result i32)  ;; label = @14
+                                i32.const 1508
+                                i32.load
+                                if  ;; label = @15
+                                  i32.const 1516
+                                  i32.load
+                                  br 1 (;@14;)
+                                end
+                                i32.const 1520
+                                i64.const -1
+                                i64.store align=4
+                                i32.const 1512
+                                i64.const 17592186048512
+                                i64.store align=4
+                                i32.const 1508
+                                local.get 10
+                                i32.const 12
+                                i32.add
+                                i32.const -16
+                                i32.and
+                                i32.const 1431655768
+                                i32.xor
+                                i32.store
+                                i32.const 1528
+                                i32.const 0
+                                i32.store
+                                i32.const 1480
+                                i32.const 0
+                                i32.store
+                                i32.const 4096
+                              end
+                              local.tee 1
+                              i32.add
+                              local.tee 6
+                              i32.const 0
+                              local.get 1
+                              i32.sub
+                              local.tee 7
+                              i32.and
+                              local.tee 4
+                              local.get 5
+                              i32.le_u
+                              br_if 12 (;@1;)
+                              i32.const 1476
+                              i32.load
+                              local.tee 1
+                              if  ;; label = @14
+                                i32.const 1468
+                                i32.load
+                                local.tee 3
+                                local.get 4
+                                i32.add
+                                local.tee 9
+                                local.get 3
+                                i32.le_u
+                                br_if 13 (;@1;)
+                                local.get 1
+                                local.get 9
+                                i32.lt_u
+                                br_if 13 (;@1;)
+                              end
+                              block  ;; label = @14
+                                i32.const 1480
+                                i32.load8_u
+                                i32.const 4
+                                i32.and
+                                i32.eqz
+                                if  ;; label = @15
+                                  block  ;; label = @16
+                                    block  ;; label = @17
+                                      block  ;; label = @18
+                                        block  ;; label = @19
+                                          i32.const 1060
+                                          i32.load
+                                          local.tee 1
+                                          if  ;; label = @20
+                                            i32.const 1484
+                                            local.set 0
+                                            loop  ;; label = @21
+                                              local.get 1
+                                              local.get 0
+                                              i32.load
+                                              local.tee 3
+                                              i32.ge_u
+                                              if  ;; label = @22
+                                                local.get 3
+                                                local.get 0
+                                                i32.load offset=4
+                                                i32.add
+                                                local.get 1
+                                                i32.gt_u
+                                                br_if 3 (;@19;)
+                                              end
+                                              local.get 0
+                                              i32.load offset=8
+                                              local.tee 0
+                                              br_if 0 (;@21;)
+                                            end
+                                          end
+                                          i32.const 0
+                                          call $sbrk
+                                          local.tee 2
+                                          i32.const -1
+                                          i32.eq
+                                          br_if 3 (;@16;)
+                                          local.get 4
+                                          local.set 6
+                                          i32.const 1512
+                                          i32.load
+                                          local.tee 0
+                                          i32.const 1
+                                          i32.sub
+                                          local.tee 1
+                                          local.get 2
+                                          i32.and
+                                          if  ;; label = @20
+                                            local.get 4
+                                            local.get 2
+                                            i32.sub
+                                            local.get 1
+                                            local.get 2
+                                            i32.add
+                                            i32.const 0
+                                            local.get 0
+                                            i32.sub
+                                            i32.and
+                                            i32.add
+                                            local.set 6
+                                          end
+                                          local.get 5
+                                          local.get 6
+                                          i32.ge_u
+                                          br_if 3 (;@16;)
+                                          i32.const 1476
+                                          i32.load
+                                          local.tee 0
+                                          if  ;; label = @20
+                                            i32.const 1468
+                                            i32.load
+                                            local.tee 1
+                                            local.get 6
+                                            i32.add
+                                            local.tee 3
+                                            local.get 1
+                                            i32.le_u
+                                            br_if 4 (;@16;)
+                                            local.get 0
+                                            local.get 3
+                                            i32.lt_u
+                                            br_if 4 (;@16;)
+                                          end
+                                          local.get 6
+                                          call $sbrk
+                                          local.tee 0
+                                          local.get 2
+                                          i32.ne
+                                          br_if 1 (;@18;)
+                                          br 5 (;@14;)
+                                        end
+                                        local.get 6
+                                        local.get 2
+                                        i32.sub
+                                        local.get 7
+                                        i32.and
+                                        local.tee 6
+                                        call $sbrk
+                                        local.tee 2
+                                        local.get 0
+                                        i32.load
+                                        local.get 0
+                                        i32.load offset=4
+                                        i32.add
+                                        i32.eq
+                                        br_if 1 (;@17;)
+                                        local.get 2
+                                        local.set 0
+                                      end
+                                      local.get 0
+                                      i32.const -1
+                                      i32.eq
+                                      br_if 1 (;@16;)
+                                      local.get 5
+                                      i32.const 48
+                                      i32.add
+                                      local.get 6
+                                      i32.le_u
+                                      if  ;; label = @18
+                                        local.get 0
+                                        local.set 2
+                                        br 4 (;@14;)
+                                      end
+                                      i32.const 1516
+                                      i32.load
+                                      local.tee 1
+                                      local.get 8
+                                      local.get 6
+                                      i32.sub
+                                      i32.add
+                                      i32.const 0
+                                      local.get 1
+                                      i32.sub
+                                      i32.and
+                                      local.tee 1
+                                      call $sbrk
+                                      i32.const -1
+                                      i32.eq
+                                      br_if 1 (;@16;)
+                                      local.get 1
+                                      local.get 6
+                                      i32.add
+                                      local.set 6
+                                      local.get 0
+                                      local.set 2
+                                      br 3 (;@14;)
+                                    end
+                                    local.get 2
+                                    i32.const -1
+                                    i32.ne
+                                    br_if 2 (;@14;)
+                                  end
+                                  i32.const 1480
+                                  i32.const 1480
+                                  i32.load
+                                  i32.const 4
+                                  i32.or
+                                  i32.store
+                                end
+                                local.get 4
+                                call $sbrk
+                                local.set 2
+                                i32.const 0
+                                call $sbrk
+                                local.set 0
+                                local.get 2
+                                i32.const -1
+                                i32.eq
+                                br_if 5 (;@9;)
+                                local.get 0
+                                i32.const -1
+                                i32.eq
+                                br_if 5 (;@9;)
+                                local.get 0
+                                local.get 2
+                                i32.le_u
+                                br_if 5 (;@9;)
+                                local.get 0
+                                local.get 2
+                                i32.sub
+                                local.tee 6
+                                local.get 5
+                                i32.const 40
+                                i32.add
+                                i32.le_u
+                                br_if 5 (;@9;)
+                              end
+                              i32.const 1468
+                              i32.const 1468
+                              i32.load
+                              local.get 6
+                              i32.add
+                              local.tee 0
+                              i32.store
+                              i32.const 1472
+                              i32.load
+                              local.get 0
+                              i32.lt_u
+                              if  ;; label = @14
+                                i32.const 1472
+                                local.get 0
+                                i32.store
+                              end
+                              block  ;; label = @14
+                                i32.const 1060
+                                i32.load
+                                local.tee 1
+                                if  ;; label = @15
+                                  i32.const 1484
+                                  local.set 0
+                                  loop  ;; label = @16
+                                    local.get 2
+                                    local.get 0
+                                    i32.load
+                                    local.tee 3
+                                    local.get 0
+                                    i32.load offset=4
+                                    local.tee 4
+                                    i32.add
+                                    i32.eq
+                                    br_if 2 (;@14;)
+                                    local.get 0
+                                    i32.load offset=8
+                                    local.tee 0
+                                    br_if 0 (;@16;)
+                                  end
+                                  br 4 (;@11;)
+                                end
+                                i32.const 1052
+                                i32.load
+                                local.tee 0
+                                i32.const 0
+                                local.get 0
+                                local.get 2
+                                i32.le_u
+                                select
+                                i32.eqz
+                                if  ;; label = @15
+                                  i32.const 1052
+                                  local.get 2
+                                  i32.store
+                                end
+                                i32.const 0
+                                local.set 0
+                                i32.const 1488
+                                local.get 6
+                                i32.store
+                                i32.const 1484
+                                local.get 2
+                                i32.store
+                                i32.const 1068
+                                i32.const -1
+                                i32.store
+                                i32.const 1072
+                                i32.const 1508
+                                i32.load
+                                i32.store
+                                i32.const 1496
+                                i32.const 0
+                                i32.store
+                                loop  ;; label = @15
+                                  local.get 0
+                                  i32.const 3
+                                  i32.shl
+                                  local.tee 1
+                                  i32.const 1084
+                                  i32.add
+                                  local.get 1
+                                  i32.const 1076
+                                  i32.add
+                                  local.tee 3
+                                  i32.store
+                                  local.get 1
+                                  i32.const 1088
+                                  i32.add
+                                  local.get 3
+                                  i32.store
+                                  local.get 0
+                                  i32.const 1
+                                  i32.add
+                                  local.tee 0
+                                  i32.const 32
+                                  i32.ne
+                                  br_if 0 (;@15;)
+                                end
+                                i32.const 1048
+                                local.get 6
+                                i32.const 40
+                                i32.sub
+                                local.tee 0
+                                i32.const -8
+                                local.get 2
+                                i32.sub
+                                i32.const 7
+                                i32.and
+                                local.tee 1
+                                i32.sub
+                                local.tee 3
+                                i32.store
+                                i32.const 1060
+                                local.get 1
+                                local.get 2
+                                i32.add
+                                local.tee 1
+                                i32.store
+                                local.get 1
+                                local.get 3
+                                i32.const 1
+                                i32.or
+                                i32.store offset=4
+                                local.get 0
+                                local.get 2
+                                i32.add
+                                i32.const 40
+                                i32.store offset=4
+                                i32.const 1064
+                                i32.const 1524
+                                i32.load
+                                i32.store
+                                br 4 (;@10;)
+                              end
+                              local.get 1
+                              local.get 2
+                              i32.ge_u
+                              br_if 2 (;@11;)
+                              local.get 1
+                              local.get 3
+                              i32.lt_u
+                              br_if 2 (;@11;)
+                              local.get 0
+                              i32.load offset=12
+                              i32.const 8
+                              i32.and
+                              br_if 2 (;@11;)
+                              local.get 0
+                              local.get 4
+                              local.get 6
+                              i32.add
+                              i32.store offset=4
+                              i32.const 1060
+                              local.get 1
+                              i32.const -8
+                              local.get 1
+                              i32.sub
+                              i32.const 7
+                              i32.and
+                              local.tee 0
+                              i32.add
+                              local.tee 3
+                              i32.store
+                              i32.const 1048
+                              i32.const 1048
+                              i32.load
+                              local.get 6
+                              i32.add
+                              local.tee 2
+                              local.get 0
+                              i32.sub
+                              local.tee 0
+                              i32.store
+                              local.get 3
+                              local.get 0
+                              i32.const 1
+                              i32.or
+                              i32.store offset=4
+                              local.get 1
+                              local.get 2
+                              i32.add
+                              i32.const 40
+                              i32.store offset=4
+                              i32.const 1064
+                              i32.const 1524
+                              i32.load
+                              i32.store
+                              br 3 (;@10;)
+                            end
+                            i32.const 0
+                            local.set 4
+                            br 10 (;@2;)
+                          end
+                          i32.const 0
+                          local.set 2
+                          br 8 (;@3;)
+                        end
+                        i32.const 1052
+                        i32.load
+                        local.tee 4
+                        local.get 2
+                        i32.gt_u
+                        if  ;; label = @11
+                          i32.const 1052
+                          local.get 2
+                          i32.store
+                          local.get 2
+                          local.set 4
+                        end
+                        local.get 2
+                        local.get 6
+                        i32.add
+                        local.set 3
+                        i32.const 1484
+                        local.set 0
+                        block  ;; label = @11
+                          block  ;; label = @12
+                            block  ;; label = @13
+                              loop  ;; label = @14
+                                local.get 3
+                                local.get 0
+                                i32.load
+                                i32.ne
+                                if  ;; label = @15
+                                  local.get 0
+                                  i32.load offset=8
+                                  local.tee 0
+                                  br_if 1 (;@14;)
+                                  br 2 (;@13;)
+                                end
+                              end
+                              local.get 0
+                              i32.load8_u offset=12
+                              i32.const 8
+                              i32.and
+                              i32.eqz
+                              br_if 1 (;@12;)
+                            end
+                            i32.const 1484
+                            local.set 0
+                            loop  ;; label = @13
+                              local.get 1
+                              local.get 0
+                              i32.load
+                              local.tee 3
+                              i32.ge_u
+                              if  ;; label = @14
+                                local.get 3
+                                local.get 0
+                                i32.load offset=4
+                                i32.add
+                                local.tee 3
+                                local.get 1
+                                i32.gt_u
+                                br_if 3 (;@11;)
+                              end
+                              local.get 0
+                              i32.load offset=8
+                              local.set 0
+                              br 0 (;@13;)
+                            end
+                            unreachable
+                          end
+                          local.get 0
+                          local.get 2
+                          i32.store
+                          local.get 0
+                          local.get 0
+                          i32.load offset=4
+                          local.get 6
+                          i32.add
+                          i32.store offset=4
+                          local.get 2
+                          i32.const -8
+                          local.get 2
+                          i32.sub
+                          i32.const 7
+                          i32.and
+                          i32.add
+                          local.tee 7
+                          local.get 5
+                          i32.const 3
+                          i32.or
+                          i32.store offset=4
+                          local.get 3
+                          i32.const -8
+                          local.get 3
+                          i32.sub
+                          i32.const 7
+                          i32.and
+                          i32.add
+                          local.tee 6
+                          local.get 5
+                          local.get 7
+                          i32.add
+                          local.tee 5
+                          i32.sub
+                          local.set 0
+                          local.get 1
+                          local.get 6
+                          i32.eq
+                          if  ;; label = @12
+                            i32.const 1060
+                            local.get 5
+                            i32.store
+                            i32.const 1048
+                            i32.const 1048
+                            i32.load
+                            local.get 0
+                            i32.add
+                            local.tee 0
+                            i32.store
+                            local.get 5
+                            local.get 0
+                            i32.const 1
+                            i32.or
+                            i32.store offset=4
+                            br 8 (;@4;)
+                          end
+                          i32.const 1056
+                          i32.load
+                          local.get 6
+                          i32.eq
+                          if  ;; label = @12
+                            i32.const 1056
+                            local.get 5
+                            i32.store
+                            i32.const 1044
+                            i32.const 1044
+                            i32.load
+                            local.get 0
+                            i32.add
+                            local.tee 0
+                            i32.store
+                            local.get 5
+                            local.get 0
+                            i32.const 1
+                            i32.or
+                            i32.store offset=4
+                            local.get 0
+                            local.get 5
+                            i32.add
+                            local.get 0
+                            i32.store
+                            br 8 (;@4;)
+                          end
+                          local.get 6
+                          i32.load offset=4
+                          local.tee 1
+                          i32.const 3
+                          i32.and
+                          i32.const 1
+                          i32.ne
+                          br_if 6 (;@5;)
+                          local.get 1
+                          i32.const -8
+                          i32.and
+                          local.set 8
+                          local.get 1
+                          i32.const 255
+                          i32.le_u
+                          if  ;; label = @12
+                            local.get 1
+                            i32.const 3
+                            i32.shr_u
+                            local.tee 4
+                            i32.const 3
+                            i32.shl
+                            i32.const 1076
+                            i32.add
+                            local.set 2
+                            local.get 6
+                            i32.load offset=12
+                            local.tee 1
+                            local.get 6
+                            i32.load offset=8
+                            local.tee 3
+                            i32.eq
+                            if  ;; label = @13
+                              i32.const 1036
+                              i32.const 1036
+                              i32.load
+                              i32.const -2
+                              local.get 4
+                              i32.rotl
+                              i32.and
+                              i32.store
+                              br 7 (;@6;)
+                            end
+                            local.get 3
+                            local.get 1
+                            i32.store offset=12
+                            local.get 1
+                            local.get 3
+                            i32.store offset=8
+                            br 6 (;@6;)
+                          end
+                          local.get 6
+                          i32.load offset=24
+                          local.set 9
+                          local.get 6
+                          local.get 6
+                          i32.load offset=12
+                          local.tee 2
+                          i32.ne
+                          if  ;; label = @12
+                            local.get 6
+                            i32.load offset=8
+                            local.tee 1
+                            local.get 2
+                            i32.store offset=12
+                            local.get 2
+                            local.get 1
+                            i32.store offset=8
+                            br 5 (;@7;)
+                          end
+                          local.get 6
+                          i32.const 20
+                          i32.add
+                          local.tee 3
+                          i32.load
+                          local.tee 1
+                          i32.eqz
+                          if  ;; label = @12
+                            local.get 6
+                            i32.load offset=16
+                            local.tee 1
+                            i32.eqz
+                            br_if 4 (;@8;)
+                            local.get 6
+                            i32.const 16
+                            i32.add
+                            local.set 3
+                          end
+                          loop  ;; label = @12
+                            local.get 3
+                            local.set 4
+                            local.get 1
+                            local.tee 2
+                            i32.const 20
+                            i32.add
+                            local.tee 3
+                            i32.load
+                            local.tee 1
+                            br_if 0 (;@12;)
+                            local.get 2
+                            i32.const 16
+                            i32.add
+                            local.set 3
+                            local.get 2
+                            i32.load offset=16
+                            local.tee 1
+                            br_if 0 (;@12;)
+                          end
+                          local.get 4
+                          i32.const 0
+                          i32.store
+                          br 4 (;@7;)
+                        end
+                        i32.const 1048
+                        local.get 6
+                        i32.const 40
+                        i32.sub
+                        local.tee 0
+                        i32.const -8
+                        local.get 2
+                        i32.sub
+                        i32.const 7
+                        i32.and
+                        local.tee 4
+                        i32.sub
+                        local.tee 7
+                        i32.store
+                        i32.const 1060
+                        local.get 2
+                        local.get 4
+                        i32.add
+                        local.tee 4
+                        i32.store
+                        local.get 4
+                        local.get 7
+                        i32.const 1
+                        i32.or
+                        i32.store offset=4
+                        local.get 0
+                        local.get 2
+                        i32.add
+                        i32.const 40
+                        i32.store offset=4
+                        i32.const 1064
+                        i32.const 1524
+                        i32.load
+                        i32.store
+                        local.get 1
+                        local.get 3
+                        i32.const 39
+                        local.get 3
+                        i32.sub
+                        i32.const 7
+                        i32.and
+                        i32.add
+                        i32.const 47
+                        i32.sub
+                        local.tee 0
+                        local.get 0
+                        local.get 1
+                        i32.const 16
+                        i32.add
+                        i32.lt_u
+                        select
+                        local.tee 4
+                        i32.const 27
+                        i32.store offset=4
+                        local.get 4
+                        i32.const 1492
+                        i64.load align=4
+                        i64.store offset=16 align=4
+                        local.get 4
+                        i32.const 1484
+                        i64.load align=4
+                        i64.store offset=8 align=4
+                        i32.const 1492
+                        local.get 4
+                        i32.const 8
+                        i32.add
+                        i32.store
+                        i32.const 1488
+                        local.get 6
+                        i32.store
+                        i32.const 1484
+                        local.get 2
+                        i32.store
+                        i32.const 1496
+                        i32.const 0
+                        i32.store
+                        local.get 4
+                        i32.const 24
+                        i32.add
+                        local.set 0
+                        loop  ;; label = @11
+                          local.get 0
+                          i32.const 7
+                          i32.store offset=4
+                          local.get 0
+                          i32.const 8
+                          i32.add
+                          local.set 2
+                          local.get 0
+                          i32.const 4
+                          i32.add
+                          local.set 0
+                          local.get 2
+                          local.get 3
+                          i32.lt_u
+                          br_if 0 (;@11;)
+                        end
+                        local.get 1
+                        local.get 4
+                        i32.eq
+                        br_if 0 (;@10;)
+                        local.get 4
+                        local.get 4
+                        i32.load offset=4
+                        i32.const -2
+                        i32.and
+                        i32.store offset=4
+                        local.get 1
+                        local.get 4
+                        local.get 1
+                        i32.sub
+                        local.tee 2
+                        i32.const 1
+                        i32.or
+                        i32.store offset=4
+                        local.get 4
+                        local.get 2
+                        i32.store
+                        local.get 2
+                        i32.const 255
+                        i32.le_u
+                        if  ;; label = @11
+                          local.get 2
+                          i32.const -8
+                          i32.and
+                          i32.const 1076
+                          i32.add
+                          local.set 0
+                          block (result i32)  ;; label = @12
+                            i32.const 1036
+                            i32.load
+                            local.tee 3
+                            i32.const 1
+                            local.get 2
+                            i32.const 3
+                            i32.shr_u
+                            i32.shl
+                            local.tee 2
+                            i32.and
+                            i32.eqz
+                            if  ;; label = @13
+                              i32.const 1036
+                              local.get 2
+                              local.get 3
+                              i32.or
+                              i32.store
+                              local.get 0
+                              br 1 (;@12;)
+                            end
+                            local.get 0
+                            i32.load offset=8
+                          end
+                          local.set 3
+                          local.get 0
+                          local.get 1
+                          i32.store offset=8
+                          local.get 3
+                          local.get 1
+                          i32.store offset=12
+                          local.get 1
+                          local.get 0
+                          i32.store offset=12
+                          local.get 1
+                          local.get 3
+                          i32.store offset=8
+                          br 1 (;@10;)
+                        end
+                        i32.const 31
+                        local.set 0
+                        local.get 2
+                        i32.const 16777215
+                        i32.le_u
+                        if  ;; label = @11
+                          local.get 2
+                          i32.const 38
+                          local.get 2
+                          i32.const 8
+                          i32.shr_u
+                          i32.clz
+                          local.tee 0
+                          i32.sub
+                          i32.shr_u
+                          i32.const 1
+                          i32.and
+                          local.get 0
+                          i32.const 1
+                          i32.shl
+                          i32.sub
+                          i32.const 62
+                          i32.add
+                          local.set 0
+                        end
+                        local.get 1
+                        local.get 0
+                        i32.store offset=28
+                        local.get 1
+                        i64.const 0
+                        i64.store offset=16 align=4
+                        local.get 0
+                        i32.const 2
+                        i32.shl
+                        i32.const 1340
+                        i32.add
+                        local.set 3
+                        block  ;; label = @11
+                          block  ;; label = @12
+                            i32.const 1040
+                            i32.load
+                            local.tee 4
+                            i32.const 1
+                            local.get 0
+                            i32.shl
+                            local.tee 6
+                            i32.and
+                            i32.eqz
+                            if  ;; label = @13
+                              i32.const 1040
+                              local.get 4
+                              local.get 6
+                              i32.or
+                              i32.store
+                              local.get 3
+                              local.get 1
+                              i32.store
+                              local.get 1
+                              local.get 3
+                              i32.store offset=24
+                              br 1 (;@12;)
+                            end
+                            local.get 2
+                            i32.const 25
+                            local.get 0
+                            i32.const 1
+                            i32.shr_u
+                            i32.sub
+                            i32.const 0
+                            local.get 0
+                            i32.const 31
+                            i32.ne
+                            select
+                            i32.shl
+                            local.set 0
+                            local.get 3
+                            i32.load
+                            local.set 4
+                            loop  ;; label = @13
+                              local.get 4
+                              local.tee 3
+                              i32.load offset=4
+                              i32.const -8
+                              i32.and
+                              local.get 2
+                              i32.eq
+                              br_if 2 (;@11;)
+                              local.get 0
+                              i32.const 29
+                              i32.shr_u
+                              local.set 4
+                              local.get 0
+                              i32.const 1
+                              i32.shl
+                              local.set 0
+                              local.get 3
+                              local.get 4
+                              i32.const 4
+                              i32.and
+                              i32.add
+                              i32.const 16
+                              i32.add
+                              local.tee 6
+                              i32.load
+                              local.tee 4
+                              br_if 0 (;@13;)
+                            end
+                            local.get 6
+                            local.get 1
+                            i32.store
+                            local.get 1
+                            local.get 3
+                            i32.store offset=24
+                          end
+                          local.get 1
+                          local.get 1
+                          i32.store offset=12
+                          local.get 1
+                          local.get 1
+                          i32.store offset=8
+                          br 1 (;@10;)
+                        end
+                        local.get 3
+                        i32.load offset=8
+                        local.tee 0
+                        local.get 1
+                        i32.store offset=12
+                        local.get 3
+                        local.get 1
+                        i32.store offset=8
+                        local.get 1
+                        i32.const 0
+                        i32.store offset=24
+                        local.get 1
+                        local.get 3
+                        i32.store offset=12
+                        local.get 1
+                        local.get 0
+                        i32.store offset=8
+                      end
+                      i32.const 1048
+                      i32.load
+                      local.tee 0
+                      local.get 5
+                      i32.le_u
+                      br_if 0 (;@9;)
+                      i32.const 1048
+                      local.get 0
+                      local.get 5
+                      i32.sub
+                      local.tee 1
+                      i32.store
+                      i32.const 1060
+                      i32.const 1060
+                      i32.load
+                      local.tee 0
+                      local.get 5
+                      i32.add
+                      local.tee 3
+                      i32.store
+                      local.get 3
+                      local.get 1
+                      i32.const 1
+                      i32.or
+                      i32.store offset=4
+                      local.get 0
+                      local.get 5
+                      i32.const 3
+                      i32.or
+                      i32.store offset=4
+                      local.get 0
+                      i32.const 8
+                      i32.add
+                      local.set 0
+                      br 8 (;@1;)
+                    end
+                    call $__errno_location
+                    i32.const 48
+                    i32.store
+                    i32.const 0
+                    local.set 0
+                    br 7 (;@1;)
+                  end
+                  i32.const 0
+                  local.set 2
+                end
+                local.get 9
+                i32.eqz
+                br_if 0 (;@6;)
+                block  ;; label = @7
+                  local.get 6
+                  i32.load offset=28
+                  local.tee 3
+                  i32.const 2
+                  i32.shl
+                  i32.const 1340
+                  i32.add
+                  local.tee 1
+                  i32.load
+                  local.get 6
+                  i32.eq
+                  if  ;; label = @8
+                    local.get 1
+                    local.get 2
+                    i32.store
+                    local.get 2
+                    br_if 1 (;@7;)
+                    i32.const 1040
+                    i32.const 1040
+                    i32.load
+                    i32.const -2
+                    local.get 3
+                    i32.rotl
+                    i32.and
+                    i32.store
+                    br 2 (;@6;)
+                  end
+                  local.get 9
+                  i32.const 16
+                  i32.const 20
+                  local.get 9
+                  i32.load offset=16
+                  local.get 6
+                  i32.eq
+                  select
+                  i32.add
+                  local.get 2
+                  i32.store
+                  local.get 2
+                  i32.eqz
+                  br_if 1 (;@6;)
+                end
+                local.get 2
+                local.get 9
+                i32.store offset=24
+                local.get 6
+                i32.load offset=16
+                local.tee 1
+                if  ;; label = @7
+                  local.get 2
+                  local.get 1
+                  i32.store offset=16
+                  local.get 1
+                  local.get 2
+                  i32.store offset=24
+                end
+                local.get 6
+                i32.load offset=20
+                local.tee 1
+                i32.eqz
+                br_if 0 (;@6;)
+                local.get 2
+                local.get 1
+                i32.store offset=20
+                local.get 1
+                local.get 2
+                i32.store offset=24
+              end
+              local.get 0
+              local.get 8
+              i32.add
+              local.set 0
+              local.get 6
+              local.get 8
+              i32.add
+              local.tee 6
+              i32.load offset=4
+              local.set 1
+            end
+            local.get 6
+            local.get 1
+            i32.const -2
+            i32.and
+            i32.store offset=4
+            local.get 5
+            local.get 0
+            i32.const 1
+            i32.or
+            i32.store offset=4
+            local.get 0
+            local.get 5
+            i32.add
+            local.get 0
+            i32.store
+            local.get 0
+            i32.const 255
+            i32.le_u
+            if  ;; label = @5
+              local.get 0
+              i32.const -8
+              i32.and
+              i32.const 1076
+              i32.add
+              local.set 1
+              block (result i32)  ;; label = @6
+                i32.const 1036
+                i32.load
+                local.tee 3
+                i32.const 1
+                local.get 0
+                i32.const 3
+                i32.shr_u
+                i32.shl
+                local.tee 0
+                i32.and
+                i32.eqz
+                if  ;; label = @7
+                  i32.const 1036
+                  local.get 0
+                  local.get 3
+                  i32.or
+                  i32.store
+                  local.get 1
+                  br 1 (;@6;)
+                end
+                local.get 1
+                i32.load offset=8
+              end
+              local.set 0
+              local.get 1
+              local.get 5
+              i32.store offset=8
+              local.get 0
+              local.get 5
+              i32.store offset=12
+              local.get 5
+              local.get 1
+              i32.store offset=12
+              local.get 5
+              local.get 0
+              i32.store offset=8
+              br 1 (;@4;)
+            end
+            i32.const 31
+            local.set 1
+            local.get 0
+            i32.const 16777215
+            i32.le_u
+            if  ;; label = @5
+              local.get 0
+              i32.const 38
+              local.get 0
+              i32.const 8
+              i32.shr_u
+              i32.clz
+              local.tee 1
+              i32.sub
+              i32.shr_u
+              i32.const 1
+              i32.and
+              local.get 1
+              i32.const 1
+              i32.shl
+              i32.sub
+              i32.const 62
+              i32.add
+              local.set 1
+            end
+            local.get 5
+            local.get 1
+            i32.store offset=28
+            local.get 5
+            i64.const 0
+            i64.store offset=16 align=4
+            local.get 1
+            i32.const 2
+            i32.shl
+            i32.const 1340
+            i32.add
+            local.set 3
+            block  ;; label = @5
+              block  ;; label = @6
+                i32.const 1040
+                i32.load
+                local.tee 2
+                i32.const 1
+                local.get 1
+                i32.shl
+                local.tee 4
+                i32.and
+                i32.eqz
+                if  ;; label = @7
+                  i32.const 1040
+                  local.get 2
+                  local.get 4
+                  i32.or
+                  i32.store
+                  local.get 3
+                  local.get 5
+                  i32.store
+                  local.get 5
+                  local.get 3
+                  i32.store offset=24
+                  br 1 (;@6;)
+                end
+                local.get 0
+                i32.const 25
+                local.get 1
+                i32.const 1
+                i32.shr_u
+                i32.sub
+                i32.const 0
+                local.get 1
+                i32.const 31
+                i32.ne
+                select
+                i32.shl
+                local.set 1
+                local.get 3
+                i32.load
+                local.set 2
+                loop  ;; label = @7
+                  local.get 2
+                  local.tee 3
+                  i32.load offset=4
+                  i32.const -8
+                  i32.and
+                  local.get 0
+                  i32.eq
+                  br_if 2 (;@5;)
+                  local.get 1
+                  i32.const 29
+                  i32.shr_u
+                  local.set 2
+                  local.get 1
+                  i32.const 1
+                  i32.shl
+                  local.set 1
+                  local.get 3
+                  local.get 2
+                  i32.const 4
+                  i32.and
+                  i32.add
+                  i32.const 16
+                  i32.add
+                  local.tee 4
+                  i32.load
+                  local.tee 2
+                  br_if 0 (;@7;)
+                end
+                local.get 4
+                local.get 5
+                i32.store
+                local.get 5
+                local.get 3
+                i32.store offset=24
+              end
+              local.get 5
+              local.get 5
+              i32.store offset=12
+              local.get 5
+              local.get 5
+              i32.store offset=8
+              br 1 (;@4;)
+            end
+            local.get 3
+            i32.load offset=8
+            local.tee 0
+            local.get 5
+            i32.store offset=12
+            local.get 3
+            local.get 5
+            i32.store offset=8
+            local.get 5
+            i32.const 0
+            i32.store offset=24
+            local.get 5
+            local.get 3
+            i32.store offset=12
+            local.get 5
+            local.get 0
+            i32.store offset=8
+          end
+          local.get 7
+          i32.const 8
+          i32.add
+          local.set 0
+          br 2 (;@1;)
+        end
+        block  ;; label = @3
+          local.get 7
+          i32.eqz
+          br_if 0 (;@3;)
+          block  ;; label = @4
+            local.get 4
+            i32.load offset=28
+            local.tee 3
+            i32.const 2
+            i32.shl
+            i32.const 1340
+            i32.add
+            local.tee 0
+            i32.load
+            local.get 4
+            i32.eq
+            if  ;; label = @5
+              local.get 0
+              local.get 2
+              i32.store
+              local.get 2
+              br_if 1 (;@4;)
+              i32.const 1040
+              local.get 8
+              i32.const -2
+              local.get 3
+              i32.rotl
+              i32.and
+              local.tee 8
+              i32.store
+              br 2 (;@3;)
+            end
+            local.get 7
+            i32.const 16
+            i32.const 20
+            local.get 7
+            i32.load offset=16
+            local.get 4
+            i32.eq
+            select
+            i32.add
+            local.get 2
+            i32.store
+            local.get 2
+            i32.eqz
+            br_if 1 (;@3;)
+          end
+          local.get 2
+          local.get 7
+          i32.store offset=24
+          local.get 4
+          i32.load offset=16
+          local.tee 0
+          if  ;; label = @4
+            local.get 2
+            local.get 0
+            i32.store offset=16
+            local.get 0
+            local.get 2
+            i32.store offset=24
+          end
+          local.get 4
+          i32.load offset=20
+          local.tee 0
+          i32.eqz
+          br_if 0 (;@3;)
+          local.get 2
+          local.get 0
+          i32.store offset=20
+          local.get 0
+          local.get 2
+          i32.store offset=24
+        end
+        block  ;; label = @3
+          local.get 1
+          i32.const 15
+          i32.le_u
+          if  ;; label = @4
+            local.get 4
+            local.get 1
+            local.get 5
+            i32.add
+            local.tee 0
+            i32.const 3
+            i32.or
+            i32.store offset=4
+            local.get 0
+            local.get 4
+            i32.add
+            local.tee 0
+            local.get 0
+            i32.load offset=4
+            i32.const 1
+            i32.or
+            i32.store offset=4
+            br 1 (;@3;)
+          end
+          local.get 4
+          local.get 5
+          i32.const 3
+          i32.or
+          i32.store offset=4
+          local.get 4
+          local.get 5
+          i32.add
+          local.tee 2
+          local.get 1
+          i32.const 1
+          i32.or
+          i32.store offset=4
+          local.get 1
+          local.get 2
+          i32.add
+          local.get 1
+          i32.store
+          local.get 1
+          i32.const 255
+          i32.le_u
+          if  ;; label = @4
+            local.get 1
+            i32.const -8
+            i32.and
+            i32.const 1076
+            i32.add
+            local.set 0
+            block (result i32)  ;; label = @5
+              i32.const 1036
+              i32.load
+              local.tee 3
+              i32.const 1
+              local.get 1
+              i32.const 3
+              i32.shr_u
+              i32.shl
+              local.tee 1
+              i32.and
+              i32.eqz
+              if  ;; label = @6
+                i32.const 1036
+                local.get 1
+                local.get 3
+                i32.or
+                i32.store
+                local.get 0
+                br 1 (;@5;)
+              end
+              local.get 0
+              i32.load offset=8
+            end
+            local.set 1
+            local.get 0
+            local.get 2
+            i32.store offset=8
+            local.get 1
+            local.get 2
+            i32.store offset=12
+            local.get 2
+            local.get 0
+            i32.store offset=12
+            local.get 2
+            local.get 1
+            i32.store offset=8
+            br 1 (;@3;)
+          end
+          i32.const 31
+          local.set 0
+          local.get 1
+          i32.const 16777215
+          i32.le_u
+          if  ;; label = @4
+            local.get 1
+            i32.const 38
+            local.get 1
+            i32.const 8
+            i32.shr_u
+            i32.clz
+            local.tee 0
+            i32.sub
+            i32.shr_u
+            i32.const 1
+            i32.and
+            local.get 0
+            i32.const 1
+            i32.shl
+            i32.sub
+            i32.const 62
+            i32.add
+            local.set 0
+          end
+          local.get 2
+          local.get 0
+          i32.store offset=28
+          local.get 2
+          i64.const 0
+          i64.store offset=16 align=4
+          local.get 0
+          i32.const 2
+          i32.shl
+          i32.const 1340
+          i32.add
+          local.set 3
+          block  ;; label = @4
+            block  ;; label = @5
+              local.get 8
+              i32.const 1
+              local.get 0
+              i32.shl
+              local.tee 5
+              i32.and
+              i32.eqz
+              if  ;; label = @6
+                i32.const 1040
+                local.get 5
+                local.get 8
+                i32.or
+                i32.store
+                local.get 3
+                local.get 2
+                i32.store
+                local.get 2
+                local.get 3
+                i32.store offset=24
+                br 1 (;@5;)
+              end
+              local.get 1
+              i32.const 25
+              local.get 0
+              i32.const 1
+              i32.shr_u
+              i32.sub
+              i32.const 0
+              local.get 0
+              i32.const 31
+              i32.ne
+              select
+              i32.shl
+              local.set 0
+              local.get 3
+              i32.load
+              local.set 5
+              loop  ;; label = @6
+                local.get 5
+                local.tee 3
+                i32.load offset=4
+                i32.const -8
+                i32.and
+                local.get 1
+                i32.eq
+                br_if 2 (;@4;)
+                local.get 0
+                i32.const 29
+                i32.shr_u
+                local.set 5
+                local.get 0
+                i32.const 1
+                i32.shl
+                local.set 0
+                local.get 3
+                local.get 5
+                i32.const 4
+                i32.and
+                i32.add
+                i32.const 16
+                i32.add
+                local.tee 6
+                i32.load
+                local.tee 5
+                br_if 0 (;@6;)
+              end
+              local.get 6
+              local.get 2
+              i32.store
+              local.get 2
+              local.get 3
+              i32.store offset=24
+            end
+            local.get 2
+            local.get 2
+            i32.store offset=12
+            local.get 2
+            local.get 2
+            i32.store offset=8
+            br 1 (;@3;)
+          end
+          local.get 3
+          i32.load offset=8
+          local.tee 0
+          local.get 2
+          i32.store offset=12
+          local.get 3
+          local.get 2
+          i32.store offset=8
+          local.get 2
+          i32.const 0
+          i32.store offset=24
+          local.get 2
+          local.get 3
+          i32.store offset=12
+          local.get 2
+          local.get 0
+          i32.store offset=8
+        end
+        local.get 4
+        i32.const 8
+        i32.add
+        local.set 0
+        br 1 (;@1;)
+      end
+      block  ;; label = @2
+        local.get 9
+        i32.eqz
+        br_if 0 (;@2;)
+        block  ;; label = @3
+          local.get 2
+          i32.load offset=28
+          local.tee 3
+          i32.const 2
+          i32.shl
+          i32.const 1340
+          i32.add
+          local.tee 0
+          i32.load
+          local.get 2
+          i32.eq
+          if  ;; label = @4
+            local.get 0
+            local.get 4
+            i32.store
+            local.get 4
+            br_if 1 (;@3;)
+            i32.const 1040
+            local.get 11
+            i32.const -2
+            local.get 3
+            i32.rotl
+            i32.and
+            i32.store
+            br 2 (;@2;)
+          end
+          local.get 9
+          i32.const 16
+          i32.const 20
+          local.get 9
+          i32.load offset=16
+          local.get 2
+          i32.eq
+          select
+          i32.add
+          local.get 4
+          i32.store
+          local.get 4
+          i32.eqz
+          br_if 1 (;@2;)
+        end
+        local.get 4
+        local.get 9
+        i32.store offset=24
+        local.get 2
+        i32.load offset=16
+        local.tee 0
+        if  ;; label = @3
+          local.get 4
+          local.get 0
+          i32.store offset=16
+          local.get 0
+          local.get 4
+          i32.store offset=24
+        end
+        local.get 2
+        i32.load offset=20
+        local.tee 0
+        i32.eqz
+        br_if 0 (;@2;)
+        local.get 4
+        local.get 0
+        i32.store offset=20
+        local.get 0
+        local.get 4
+        i32.store offset=24
+      end
+      block  ;; label = @2
+        local.get 1
+        i32.const 15
+        i32.le_u
+        if  ;; label = @3
+          local.get 2
+          local.get 1
+          local.get 5
+          i32.add
+          local.tee 0
+          i32.const 3
+          i32.or
+          i32.store offset=4
+          local.get 0
+          local.get 2
+          i32.add
+          local.tee 0
+          local.get 0
+          i32.load offset=4
+          i32.const 1
+          i32.or
+          i32.store offset=4
+          br 1 (;@2;)
+        end
+        local.get 2
+        local.get 5
+        i32.const 3
+        i32.or
+        i32.store offset=4
+        local.get 2
+        local.get 5
+        i32.add
+        local.tee 3
+        local.get 1
+        i32.const 1
+        i32.or
+        i32.store offset=4
+        local.get 1
+        local.get 3
+        i32.add
+        local.get 1
+        i32.store
+        local.get 8
+        if  ;; label = @3
+          local.get 8
+          i32.const -8
+          i32.and
+          i32.const 1076
+          i32.add
+          local.set 5
+          i32.const 1056
+          i32.load
+          local.set 0
+          block (result i32)  ;; label = @4
+            i32.const 1
+            local.get 8
+            i32.const 3
+            i32.shr_u
+            i32.shl
+            local.tee 4
+            local.get 6
+            i32.and
+            i32.eqz
+            if  ;; label = @5
+              i32.const 1036
+              local.get 4
+              local.get 6
+              i32.or
+              i32.store
+              local.get 5
+              br 1 (;@4;)
+            end
+            local.get 5
+            i32.load offset=8
+          end
+          local.set 4
+          local.get 5
+          local.get 0
+          i32.store offset=8
+          local.get 4
+          local.get 0
+          i32.store offset=12
+          local.get 0
+          local.get 5
+          i32.store offset=12
+          local.get 0
+          local.get 4
+          i32.store offset=8
+        end
+        i32.const 1056
+        local.get 3
+        i32.store
+        i32.const 1044
+        local.get 1
+        i32.store
+      end
+      local.get 2
+      i32.const 8
+      i32.add
+      local.set 0
+    end
+    local.get 10
+    i32.const 16
+    i32.add
+    global.set $__stack_pointer
+    local.get 0)
+  (func $stackSave (type 1) (result i32)
+    global.get $__stack_pointer)
+  (func $stackRestore (type 2) (param i32)
+    local.get 0
+    global.set $__stack_pointer)
+  (func $stackAlloc (type 0) (param i32) (result i32)
+    (local i32)
+    global.get $__stack_pointer
+    local.get 0
+    i32.sub
+    i32.const -16
+    i32.and
+    local.tee 1
+    global.set $__stack_pointer
+    local.get 1)
+  (func $asyncify_start_unwind (type 2) (param i32)
+    i32.const 1
+    global.set $__asyncify_state
+    local.get 0
+    global.set $__asyncify_data
+    global.get $__asyncify_data
+    i32.load
+    global.get $__asyncify_data
+    i32.load offset=4
+    i32.gt_u
+    if  ;; label = @1
+      unreachable
+    end)
+  (func $asyncify_stop_unwind (type 3)
+    i32.const 0
+    global.set $__asyncify_state
+    global.get $__asyncify_data
+    i32.load
+    global.get $__asyncify_data
+    i32.load offset=4
+    i32.gt_u
+    if  ;; label = @1
+      unreachable
+    end)
+  (func $asyncify_start_rewind (type 2) (param i32)
+    i32.const 2
+    global.set $__asyncify_state
+    local.get 0
+    global.set $__asyncify_data
+    global.get $__asyncify_data
+    i32.load
+    global.get $__asyncify_data
+    i32.load offset=4
+    i32.gt_u
+    if  ;; label = @1
+      unreachable
+    end)
+  (func $asyncify_stop_rewind (type 3)
+    i32.const 0
+    global.set $__asyncify_state
+    global.get $__asyncify_data
+    i32.load
+    global.get $__asyncify_data
+    i32.load offset=4
+    i32.gt_u
+    if  ;; label = @1
+      unreachable
+    end)
+  (func $asyncify_get_state (type 1) (result i32)
+    global.get $__asyncify_state)
+  (table (;0;) 2 2 funcref)
+  (memory (;0;) 256 32768)
+  (global $__stack_pointer (mut i32) (i32.const 67072))
+  (global $__asyncify_state (mut i32) (i32.const 0))
+  (global $__asyncify_data (mut i32) (i32.const 0))
+  (export "memory" (memory 0))
+  (export "function" (func $function))
+  (export "alloc" (func $alloc))
+  (export "__indirect_function_table" (table 0))
+  (export "_initialize" (func $_initialize))
+  (export "__errno_location" (func $__errno_location))
+  (export "stackSave" (func $stackSave))
+  (export "stackRestore" (func $stackRestore))
+  (export "stackAlloc" (func $stackAlloc))
+  (export "asyncify_start_unwind" (func $asyncify_start_unwind))
+  (export "asyncify_stop_unwind" (func $asyncify_stop_unwind))
+  (export "asyncify_start_rewind" (func $asyncify_start_rewind))
+  (export "asyncify_stop_rewind" (func $asyncify_stop_rewind))
+  (export "asyncify_get_state" (func $asyncify_get_state))
+  (elem (;0;) (i32.const 1) func $__wasm_call_ctors)
+  (data $.data (i32.const 1025) "\06\01"))
@@ -1,17 +1,18 @@
-#include <emscripten/emscripten.h>
-
 #include <algorithm>
 #include <cmath>
 #include <complex>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <functional>
 #include <numeric>
 #include <ranges>
 #include <span>
 
+#include "keepalive.hpp"
 #include "mandelbrot.ipp"
 
-std::size_t output_size;
+thread_local std::size_t output_size;
 
 // return result ptr so function may reuse memory given to it
 // this function can be considered an SDK
@@ -0,0 +1,10 @@
+#pragma once
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten/emscripten.h>
+#else
+// native builds of the functions are loaded with dlopen by the trusted native
+// tier, so the exports need to be visible. one loaded copy serves concurrent
+// requests there, which is why the functions keep their state thread_local.
+#define EMSCRIPTEN_KEEPALIVE __attribute__((used, visibility("default")))
+#endif
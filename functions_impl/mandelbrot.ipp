@@ -1,10 +1,35 @@
 
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#endif
+#ifdef __EMSCRIPTEN__
+#include "parallel_for.hpp"
+#endif
+
 namespace {
 using scalar_t = double;
 const scalar_t inf = std::numeric_limits<scalar_t>::infinity();
 const int max_iterations = 100;
 const int divergent_threashold = 2;
 
+const auto im_lower = -1.0;
+const auto im_upper = 1.0;
+const auto re_lower = -2.0;
+const auto re_upper = 1.0;
+const auto samples_per_unit = 1000;
+
+const auto re_samples = int(samples_per_unit * (re_upper - re_lower));
+const auto im_samples = int(samples_per_unit * (im_upper - im_lower));
+
+scalar_t re_at(int idx) {
+	return idx * (re_upper - re_lower) / re_samples + re_lower;
+}
+scalar_t im_at(int idx) {
+	return idx * (im_upper - im_lower) / im_samples + im_lower;
+}
+
+// scalar reference, compute_verification checks the vectorized version against
+// it
 auto iterations_to_diverge(const std::complex<scalar_t>& c) {
 	unsigned char n = 0;
 	auto zn = c;
@@ -16,40 +41,101 @@ auto iterations_to_diverge(const std::complex<scalar_t>& c) {
 		zn = zn * zn + c;
 	}
 }
+
+// as many points as fit into the widest vector registers we are compiled for,
+// wasm simd128 and sse2 hold two doubles
+#if defined(__AVX512F__)
+const int lanes = 8;
+#elif defined(__AVX__)
+const int lanes = 4;
+#else
+const int lanes = 2;
+#endif
+using vec_t = scalar_t __attribute__((vector_size(lanes * sizeof(scalar_t))));
+using mask_t =
+	std::int64_t __attribute__((vector_size(lanes * sizeof(std::int64_t))));
+
+bool any(mask_t mask) {
+#ifdef __wasm_simd128__
+	return wasm_v128_any_true(v128_t(mask));
+#else
+	for (auto lane = 0; lane < lanes; ++lane) {
+		if (mask[lane]) {
+			return true;
+		}
+	}
+	return false;
+#endif
+}
+
+// iterates all lanes at once, lanes that diverged are masked out of the count
+// until every lane diverged or max_iterations is reached. |z| > 2 is checked as
+// |z|^2 > 4 which avoids the sqrt of std::abs. the update is written out to
+// round exactly like the complex multiplication of the scalar version.
+auto iterations_to_diverge(vec_t re, vec_t im) {
+	const scalar_t threshold = divergent_threashold * divergent_threashold;
+	auto x = re;
+	auto y = im;
+	mask_t n{};
+	mask_t active = ~mask_t{};
+	for (auto i = 0; i < max_iterations; ++i) {
+		active &= x * x + y * y <= threshold;
+		if (!any(active)) {
+			break;
+		}
+		// subtracting the all ones mask increments the active lanes
+		n -= active;
+		const auto x_next = x * x - y * y + re;
+		y = x * y + y * x + im;
+		x = x_next;
+	}
+	return n;
+}
+
+void iterations_row(int im_idx, std::span<unsigned char> row) {
+	const auto im = im_at(im_idx);
+	auto re_idx = 0;
+	for (; re_idx + lanes <= re_samples; re_idx += lanes) {
+		vec_t res, ims;
+		for (auto lane = 0; lane < lanes; ++lane) {
+			res[lane] = re_at(re_idx + lane);
+			ims[lane] = im;
+		}
+		const auto n = iterations_to_diverge(res, ims);
+		for (auto lane = 0; lane < lanes; ++lane) {
+			row[re_idx + lane] = n[lane];
+		}
+	}
+	for (; re_idx < re_samples; ++re_idx) {
+		row[re_idx] = iterations_to_diverge(std::complex{re_at(re_idx), im});
+	}
+}
+
+[[maybe_unused]] void
+row_body(std::int32_t im_idx, const char* /*input*/, std::size_t, char* row) {
+	iterations_row(
+		im_idx, {reinterpret_cast<unsigned char*>(row), std::size_t(re_samples)}
+	);
+}
 } // namespace
 
 auto foo(std::span<char> /*input*/) {
-	namespace views = std::views;
-	using namespace std::complex_literals;
-	const auto im_lower = -1.0;
-	const auto im_upper = 1.0;
-	const auto re_lower = -2.0;
-	const auto re_upper = 1.0;
-	const auto samples_per_unit = 1000;
-
-	const auto re_samples = int(samples_per_unit * (re_upper - re_lower));
-	const auto im_samples = int(samples_per_unit * (im_upper - im_lower));
-
-	auto Ims = views::iota(0, im_samples) |
-	           views::transform([=](auto idx) -> scalar_t {
-				   return idx * (im_upper - im_lower) / im_samples + im_lower;
-			   });
-	auto Res = views::iota(0, re_samples) |
-	           views::transform([=](auto idx) -> scalar_t {
-				   return idx * (re_upper - re_lower) / re_samples + re_lower;
-			   });
-
 	// throwing new unfortunately cannot be used in wasm
 	auto* iters_mem =
-		static_cast<unsigned char*>(std::malloc(Res.size() * Ims.size()));
-	auto iters = std::span(iters_mem, Res.size() * Ims.size());
+		static_cast<unsigned char*>(std::malloc(re_samples * im_samples));
+	auto iters = std::span(iters_mem, re_samples * im_samples);
 
-	std::int64_t idx = 0;
-	for (auto im : Ims) {
-		for (auto re : Res) {
-			iters[idx++] = iterations_to_diverge(std::complex{re, im});
-		}
+#ifdef __EMSCRIPTEN__
+	// rows are independent, so the host may compute them in parallel
+	parallel_for(
+		0, im_samples, row_body, nullptr, 0, reinterpret_cast<char*>(iters_mem),
+		re_samples
+	);
+#else
+	for (auto im_idx = 0; im_idx < im_samples; ++im_idx) {
+		iterations_row(im_idx, iters.subspan(im_idx * re_samples, re_samples));
 	}
+#endif
 	auto hash = std::accumulate(
 		iters.begin(), iters.end(), std::uint64_t(0), std::plus<>{}
 	);
@@ -1,11 +1,11 @@
 
-#include <emscripten/emscripten.h>
-
 #include <algorithm>
 #include <cstdlib>
 #include <span>
 
-std::size_t output_size;
+#include "keepalive.hpp"
+
+thread_local std::size_t output_size;
 
 auto foo(std::span<char> input) {
 	return std::span<char>{};
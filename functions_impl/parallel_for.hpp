@@ -0,0 +1,18 @@
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// provided by the host, which spreads the iterations over its worker threads.
+// every iteration i calls body(i, input, input_size, output + (i - begin) *
+// stride) in an instance of its own that holds a copy of input. iterations may
+// therefore only read input and write their stride bytes of output, which are
+// copied back to the caller once all iterations are done.
+extern "C" __attribute__((import_module("env"), import_name("parallel_for")))
+void parallel_for(
+	std::int32_t begin, std::int32_t end,
+	void (*body)(std::int32_t i, const char* input, std::size_t input_size,
+                 char* output),
+	const char* input, std::size_t input_size, char* output, std::size_t stride
+);
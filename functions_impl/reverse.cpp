@@ -1,14 +1,15 @@
 
-#include <emscripten/emscripten.h>
-
 #include <algorithm>
 #include <cstdlib>
 #include <span>
 
-std::size_t output_size;
+#include "keepalive.hpp"
+#include "reverse.ipp"
+
+thread_local std::size_t output_size;
 
 auto foo(std::span<char> input) {
-	std::ranges::reverse(input);
+	reverse_bytes(input);
 	return input;
 }
 
@@ -0,0 +1,54 @@
+
+#ifdef __wasm_simd128__
+#include <wasm_simd128.h>
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+// swaps blocks from both ends towards the middle, reversing the bytes inside
+// each block with a single shuffle. less than two blocks are left in the middle,
+// which are reversed bytewise. reverse_verification checks this against
+// std::ranges::reverse.
+void reverse_bytes(std::span<char> data) {
+	auto* lo = data.data();
+	auto* hi = data.data() + data.size();
+
+#if defined(__wasm_simd128__)
+	const std::ptrdiff_t block = sizeof(v128_t);
+	auto reverse_block = [](v128_t v) {
+		return wasm_i8x16_shuffle(
+			v, v, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0
+		);
+	};
+	for (; hi - lo >= 2 * block; lo += block, hi -= block) {
+		const auto front = wasm_v128_load(lo);
+		const auto back = wasm_v128_load(hi - block);
+		wasm_v128_store(lo, reverse_block(back));
+		wasm_v128_store(hi - block, reverse_block(front));
+	}
+#elif defined(__AVX2__)
+	const std::ptrdiff_t block = sizeof(__m256i);
+	const auto indices = _mm256_setr_epi8(
+		15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, //
+		15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0
+	);
+	// the byte shuffle cannot cross the 128 bit lanes, the permute swaps them
+	auto reverse_block = [&](__m256i v) {
+		v = _mm256_shuffle_epi8(v, indices);
+		return _mm256_permute2x128_si256(v, v, 1);
+	};
+	for (; hi - lo >= 2 * block; lo += block, hi -= block) {
+		const auto front = _mm256_loadu_si256(reinterpret_cast<__m256i*>(lo));
+		const auto back =
+			_mm256_loadu_si256(reinterpret_cast<__m256i*>(hi - block));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(lo), reverse_block(back));
+		_mm256_storeu_si256(
+			reinterpret_cast<__m256i*>(hi - block), reverse_block(front)
+		);
+	}
+#endif
+
+	std::reverse(lo, hi);
+}
+} // namespace
@@ -1,10 +1,10 @@
-#include <emscripten/emscripten.h>
-
 #include <algorithm>
 #include <cstdint>
 #include <cstdlib>
 #include <span>
 
+#include "keepalive.hpp"
+
 extern "C" uint8_t get_byte();
 extern "C" uint8_t more();
 extern "C" void put_byte(uint8_t output);
@@ -14,3 +14,8 @@ extern "C" EMSCRIPTEN_KEEPALIVE void function() {
 		put_byte(get_byte());
 	}
 }
+
+// the wasm host allocates the buffer the stack is unwound into with it
+extern "C" EMSCRIPTEN_KEEPALIVE void* alloc(std::size_t size) {
+	return std::malloc(size);
+}
@@ -0,0 +1,521 @@
+
+// http/2 over cleartext tcp with prior knowledge (h2c), as nginx's grpc_pass or
+// curl --http2-prior-knowledge speak it. every request is a stream of its own
+// connection, so a client runs many invocations at once over few connections
+// and a slow one does not hold back the others. the framing, hpack and flow
+// control are done by nghttp2. window updates are sent only for body the
+// server has taken, so each stream may have at most h2c_stream_window bytes of
+// request body in flight that a slow function has not consumed yet.
+//
+// sessions live on the executor of their socket, all nghttp2 calls happen
+// there. streams are handed to the server when their headers are complete, the
+// server may answer them from any thread.
+#pragma once
+
+#include "buffer_pool.hpp"
+
+#include <boost/asio.hpp>
+#include <nghttp2/nghttp2.h>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// the port of the h2c listener, none if FAASHION_H2C_PORT is not set
+inline const std::optional<unsigned short> h2c_port =
+	[]() -> std::optional<unsigned short> {
+	if (const auto* port = std::getenv("FAASHION_H2C_PORT")) {
+		return static_cast<unsigned short>(std::stoul(port));
+	}
+	return std::nullopt;
+}();
+
+inline constexpr std::int32_t h2c_stream_window = 4 << 20;
+inline constexpr std::int32_t h2c_connection_window = 64 << 20;
+inline constexpr std::uint32_t h2c_max_streams = 1024;
+// bodies are reserved from their content-length up to this size, larger ones
+// grow as they arrive
+inline constexpr std::size_t h2c_max_reserve = 64 << 20;
+
+class h2c_session;
+
+// a request and its response
+class h2c_stream : public std::enable_shared_from_this<h2c_stream> {
+public:
+	using executor_type = boost::asio::ip::tcp::socket::executor_type;
+
+	h2c_stream(
+		std::int32_t id, executor_type executor,
+		std::weak_ptr<h2c_session> session
+	)
+		: id_(id), executor_(std::move(executor)),
+		  session_(std::move(session)) {}
+
+	std::string method, path;
+	std::optional<std::uint64_t> content_length;
+	// the request body, unless on_data takes it
+	pooled_bytes body;
+
+	// set by the server when it is handed the stream, called on the session's
+	// executor. on_data receives the body as it arrives if set, on_end once it
+	// is complete. the callbacks must not throw.
+	std::function<void(std::span<const std::uint8_t>)> on_data;
+	std::function<void()> on_end;
+
+	// gives the flow control window of bytes that on_data was handed back to
+	// the client once the server processed them. bodies collected in body are
+	// consumed as they arrive. may be called from any thread.
+	void consume(std::size_t bytes);
+
+	// the response methods may be called from any thread, in this order. the
+	// body can be written in parts until the response is finished.
+	void start_response(unsigned status, std::string content_type);
+	void write(pooled_bytes part);
+	void finish();
+	// ends the stream with an error, e.g. after the response was started
+	void reset();
+
+	void respond(unsigned status, std::string content_type, pooled_bytes body) {
+		start_response(status, std::move(content_type));
+		write(std::move(body));
+		finish();
+	}
+	void respond(unsigned status, std::string_view text) {
+		respond(status, "text/plain", pooled_bytes(text.begin(), text.end()));
+	}
+
+private:
+	friend class h2c_session;
+
+	const std::int32_t id_;
+	const executor_type executor_;
+	const std::weak_ptr<h2c_session> session_;
+
+	// only used on the session's executor
+	bool headers_done_ = false, closed_ = false, finished_ = false;
+	std::deque<pooled_bytes> parts_;
+	std::size_t part_offset_ = 0;
+	// handed to on_data but not consumed yet
+	std::size_t unconsumed_ = 0;
+
+	// runs f on the session's executor if the stream is still open
+	void post(auto f);
+};
+
+class h2c_session : public std::enable_shared_from_this<h2c_session> {
+public:
+	using handler = std::function<void(std::shared_ptr<h2c_stream>)>;
+
+	h2c_session(boost::asio::ip::tcp::socket socket, handler on_stream)
+		: socket_(std::move(socket)), on_stream_(std::move(on_stream)) {}
+
+	h2c_session(const h2c_session&) = delete;
+	h2c_session& operator=(const h2c_session&) = delete;
+
+	~h2c_session() {
+		if (session_) {
+			nghttp2_session_del(session_);
+		}
+	}
+
+	void start() {
+		nghttp2_session_callbacks* callbacks;
+		nghttp2_session_callbacks_new(&callbacks);
+		nghttp2_session_callbacks_set_on_begin_headers_callback(
+			callbacks, on_begin_headers
+		);
+		nghttp2_session_callbacks_set_on_header_callback(callbacks, on_header);
+		nghttp2_session_callbacks_set_on_frame_recv_callback(
+			callbacks, on_frame_recv
+		);
+		nghttp2_session_callbacks_set_on_data_chunk_recv_callback(
+			callbacks, on_data_chunk_recv
+		);
+		nghttp2_session_callbacks_set_on_stream_close_callback(
+			callbacks, on_stream_close
+		);
+		// the window is only updated for consumed body, see
+		// h2c_stream::consume
+		nghttp2_option* option;
+		nghttp2_option_new(&option);
+		nghttp2_option_set_no_auto_window_update(option, 1);
+		nghttp2_session_server_new2(&session_, callbacks, this, option);
+		nghttp2_option_del(option);
+		nghttp2_session_callbacks_del(callbacks);
+
+		const nghttp2_settings_entry settings[] = {
+			{NGHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS, h2c_max_streams},
+			{NGHTTP2_SETTINGS_INITIAL_WINDOW_SIZE, h2c_stream_window}};
+		nghttp2_submit_settings(
+			session_, NGHTTP2_FLAG_NONE, settings, std::size(settings)
+		);
+		nghttp2_session_set_local_window_size(
+			session_, NGHTTP2_FLAG_NONE, 0, h2c_connection_window
+		);
+		flush();
+		read();
+	}
+
+private:
+	friend class h2c_stream;
+
+	boost::asio::ip::tcp::socket socket_;
+	handler on_stream_;
+	nghttp2_session* session_ = nullptr;
+	std::unordered_map<std::int32_t, std::shared_ptr<h2c_stream>> streams_;
+
+	std::array<std::uint8_t, 16 << 10> read_buffer_;
+	std::vector<std::uint8_t> write_buffer_;
+	bool writing_ = false;
+
+	void read() {
+		socket_.async_read_some(
+			boost::asio::buffer(read_buffer_),
+			[self = shared_from_this()](
+				boost::system::error_code ec, std::size_t bytes_transferred
+			) {
+				if (ec) {
+					self->close();
+					return;
+				}
+				if (nghttp2_session_mem_recv(
+						self->session_, self->read_buffer_.data(),
+						bytes_transferred
+					) < 0) {
+					self->close();
+					return;
+				}
+				self->flush();
+				self->read();
+			}
+		);
+	}
+
+	// writes what nghttp2 has queued, one write at a time
+	void flush() {
+		if (writing_ or !socket_.is_open()) {
+			return;
+		}
+		write_buffer_.clear();
+		for (;;) {
+			const std::uint8_t* data;
+			const auto size = nghttp2_session_mem_send(session_, &data);
+			if (size < 0) {
+				close();
+				return;
+			}
+			if (size == 0) {
+				break;
+			}
+			write_buffer_.insert(write_buffer_.end(), data, data + size);
+			if (write_buffer_.size() >= 64 << 10) {
+				break;
+			}
+		}
+		if (write_buffer_.empty()) {
+			if (!nghttp2_session_want_read(session_) and
+			    !nghttp2_session_want_write(session_)) {
+				close();
+			}
+			return;
+		}
+		writing_ = true;
+		boost::asio::async_write(
+			socket_, boost::asio::buffer(write_buffer_),
+			[self = shared_from_this(
+			 )](boost::system::error_code ec, std::size_t) {
+				self->writing_ = false;
+				if (ec) {
+					self->close();
+					return;
+				}
+				self->flush();
+			}
+		);
+	}
+
+	void close() {
+		boost::system::error_code ec;
+		socket_.close(ec);
+		for (auto& [id, stream] : streams_) {
+			stream->closed_ = true;
+			stream->on_data = nullptr;
+			stream->on_end = nullptr;
+		}
+		streams_.clear();
+	}
+
+	// the body a started response has queued, nghttp2 asks again after
+	// nghttp2_session_resume_data if there was none
+	static ssize_t read_body(
+		nghttp2_session*, std::int32_t, std::uint8_t* buffer,
+		std::size_t length, std::uint32_t* flags, nghttp2_data_source* source,
+		void*
+	) {
+		auto* stream = static_cast<h2c_stream*>(source->ptr);
+		std::size_t copied = 0;
+		while (copied < length and !stream->parts_.empty()) {
+			const auto& part = stream->parts_.front();
+			const auto n =
+				std::min(length - copied, part.size() - stream->part_offset_);
+			std::copy_n(
+				part.data() + stream->part_offset_, n, buffer + copied
+			);
+			copied += n;
+			stream->part_offset_ += n;
+			if (stream->part_offset_ == part.size()) {
+				stream->parts_.pop_front();
+				stream->part_offset_ = 0;
+			}
+		}
+		if (stream->parts_.empty() and stream->finished_) {
+			*flags |= NGHTTP2_DATA_FLAG_EOF;
+		} else if (copied == 0) {
+			return NGHTTP2_ERR_DEFERRED;
+		}
+		return ssize_t(copied);
+	}
+
+	h2c_stream* find(std::int32_t id) {
+		auto it = streams_.find(id);
+		return it == streams_.end() ? nullptr : it->second.get();
+	}
+
+	// nothing may be thrown through nghttp2's c frames. a callback that fails
+	// makes nghttp2 reset the stream it was called for.
+	static int guarded(auto f) noexcept {
+		try {
+			f();
+			return 0;
+		} catch (const std::exception& e) {
+			std::cerr << "h2c stream failed: " << e.what() << '\n';
+		} catch (...) {
+			std::cerr << "h2c stream failed\n";
+		}
+		return NGHTTP2_ERR_TEMPORAL_CALLBACK_FAILURE;
+	}
+
+	static int
+	on_begin_headers(nghttp2_session*, const nghttp2_frame* frame, void* user) {
+		auto* self = static_cast<h2c_session*>(user);
+		if (frame->hd.type != NGHTTP2_HEADERS or
+		    frame->headers.cat != NGHTTP2_HCAT_REQUEST) {
+			return 0;
+		}
+		return guarded([&] {
+			self->streams_.emplace(
+				frame->hd.stream_id,
+				std::make_shared<h2c_stream>(
+					frame->hd.stream_id, self->socket_.get_executor(),
+					self->weak_from_this()
+				)
+			);
+		});
+	}
+
+	static int on_header(
+		nghttp2_session*, const nghttp2_frame* frame, const std::uint8_t* name,
+		std::size_t name_length, const std::uint8_t* value,
+		std::size_t value_length, std::uint8_t, void* user
+	) {
+		auto* stream =
+			static_cast<h2c_session*>(user)->find(frame->hd.stream_id);
+		if (!stream or stream->headers_done_) {
+			return 0;
+		}
+		const std::string_view header{
+			reinterpret_cast<const char*>(name), name_length};
+		const std::string_view text{
+			reinterpret_cast<const char*>(value), value_length};
+		return guarded([&] {
+			if (header == ":method") {
+				stream->method = text;
+			} else if (header == ":path") {
+				stream->path = text;
+			} else if (header == "content-length") {
+				std::uint64_t length;
+				if (std::from_chars(
+						text.data(), text.data() + text.size(), length
+					)
+				        .ec == std::errc{}) {
+					// the client may claim anything
+					stream->content_length = length;
+					stream->body.reserve(std::min<std::uint64_t>(
+						length, h2c_max_reserve
+					));
+				}
+			}
+		});
+	}
+
+	static int
+	on_frame_recv(nghttp2_session*, const nghttp2_frame* frame, void* user) {
+		auto* self = static_cast<h2c_session*>(user);
+		auto it = self->streams_.find(frame->hd.stream_id);
+		if (it == self->streams_.end()) {
+			return 0;
+		}
+		auto stream = it->second;
+		return guarded([&] {
+			if (frame->hd.type == NGHTTP2_HEADERS and !stream->headers_done_) {
+				stream->headers_done_ = true;
+				self->on_stream_(stream);
+			}
+			if ((frame->hd.type == NGHTTP2_HEADERS or
+			     frame->hd.type == NGHTTP2_DATA) and
+			    frame->hd.flags & NGHTTP2_FLAG_END_STREAM) {
+				// the callbacks may hold the stream
+				auto on_end = std::move(stream->on_end);
+				stream->on_data = nullptr;
+				stream->on_end = nullptr;
+				if (on_end) {
+					on_end();
+				}
+			}
+		});
+	}
+
+	static int on_data_chunk_recv(
+		nghttp2_session* session, std::uint8_t, std::int32_t id,
+		const std::uint8_t* data, std::size_t length, void* user
+	) {
+		auto* stream = static_cast<h2c_session*>(user)->find(id);
+		if (!stream) {
+			nghttp2_session_consume_connection(session, length);
+			return 0;
+		}
+		return guarded([&] {
+			if (stream->on_data) {
+				stream->unconsumed_ += length;
+				stream->on_data({data, length});
+			} else {
+				stream->body.insert(stream->body.end(), data, data + length);
+				nghttp2_session_consume(session, id, length);
+			}
+		});
+	}
+
+	static int on_stream_close(
+		nghttp2_session* session, std::int32_t id, std::uint32_t, void* user
+	) {
+		auto* self = static_cast<h2c_session*>(user);
+		if (auto it = self->streams_.find(id); it != self->streams_.end()) {
+			// consume calls after this are dropped, the connection's window
+			// gets the rest back now
+			nghttp2_session_consume_connection(
+				session, std::exchange(it->second->unconsumed_, 0)
+			);
+			it->second->closed_ = true;
+			it->second->on_data = nullptr;
+			it->second->on_end = nullptr;
+			self->streams_.erase(it);
+		}
+		return 0;
+	}
+};
+
+void h2c_stream::post(auto f) {
+	boost::asio::post(
+		executor_,
+		[self = shared_from_this(), f = std::move(f)]() mutable {
+			auto session = self->session_.lock();
+			if (session and !self->closed_) {
+				f(*session);
+				session->flush();
+			}
+		}
+	);
+}
+
+inline void
+h2c_stream::start_response(unsigned status, std::string content_type) {
+	post([this, status, content_type = std::move(content_type)](
+			 h2c_session& session
+		 ) {
+		const auto status_text = std::to_string(status);
+		// nghttp2 copies the headers, it does not write to them
+		auto bytes = [](std::string_view text) {
+			return reinterpret_cast<std::uint8_t*>(const_cast<char*>(text.data()
+			));
+		};
+		auto header = [&](std::string_view name, std::string_view value) {
+			return nghttp2_nv{
+				bytes(name), bytes(value), name.size(), value.size(),
+				NGHTTP2_NV_FLAG_NONE};
+		};
+		const nghttp2_nv headers[] = {
+			header(":status", status_text),
+			header("content-type", content_type)};
+		nghttp2_data_provider provider;
+		provider.source.ptr = this;
+		provider.read_callback = h2c_session::read_body;
+		nghttp2_submit_response(
+			session.session_, id_, headers, std::size(headers), &provider
+		);
+	});
+}
+
+inline void h2c_stream::write(pooled_bytes part) {
+	if (part.empty()) {
+		return;
+	}
+	post([this, part = std::move(part)](h2c_session& session) mutable {
+		parts_.push_back(std::move(part));
+		nghttp2_session_resume_data(session.session_, id_);
+	});
+}
+
+inline void h2c_stream::consume(std::size_t bytes) {
+	post([this, bytes](h2c_session& session) {
+		unconsumed_ -= bytes;
+		nghttp2_session_consume(session.session_, id_, bytes);
+	});
+}
+
+inline void h2c_stream::finish() {
+	post([this](h2c_session& session) {
+		finished_ = true;
+		nghttp2_session_resume_data(session.session_, id_);
+	});
+}
+
+inline void h2c_stream::reset() {
+	post([this](h2c_session& session) {
+		nghttp2_submit_rst_stream(
+			session.session_, NGHTTP2_FLAG_NONE, id_, NGHTTP2_INTERNAL_ERROR
+		);
+	});
+}
+
+// "loop" forever accepting h2c connections, whose streams are handed to
+// on_stream
+inline void h2c_server(
+	boost::asio::ip::tcp::acceptor& acceptor,
+	boost::asio::ip::tcp::socket& socket, h2c_session::handler on_stream
+) {
+	acceptor.async_accept(
+		socket,
+		[&, on_stream = std::move(on_stream)](boost::system::error_code ec) {
+			if (!ec) {
+				socket.set_option(boost::asio::ip::tcp::no_delay{true});
+				std::make_shared<h2c_session>(std::move(socket), on_stream)
+					->start();
+			}
+			h2c_server(acceptor, socket, on_stream);
+		}
+	);
+}
@@ -0,0 +1,127 @@
+
+// transparent huge pages for linear memories, enabled with FAASHION_HUGE_PAGES.
+// functions that touch large parts of their memory then take a page fault and
+// a tlb entry per 2MB instead of per 4KB. memories are created by the host for
+// that, so like with FAASHION_MAP_INPUTS wasmtime copies module images into
+// them instead of mapping them.
+//
+// the kernel only backs ranges of advised mappings with huge pages if they are
+// aligned and whole 2MB pages are accessible, and only if
+// /sys/kernel/mm/transparent_hugepage/enabled (shmem_enabled for memfd backed
+// memories) is madvise or always.
+#pragma once
+
+#include "wasmtime.hh"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+inline const bool huge_pages = std::getenv("FAASHION_HUGE_PAGES") != nullptr;
+
+inline constexpr std::size_t huge_page_size = 2 << 20;
+
+inline void advise_huge_pages(void* data, std::size_t size) {
+	if (huge_pages and size != 0) {
+		madvise(data, size, MADV_HUGEPAGE);
+	}
+}
+
+// an inaccessible range of address space, aligned to huge pages if they are
+// used. nullptr if it can not be reserved.
+inline std::uint8_t* reserve_address_space(std::size_t size) {
+	const auto slack = huge_pages ? huge_page_size : 0;
+	auto* mapping = mmap(
+		nullptr, size + slack, PROT_NONE,
+		MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0
+	);
+	if (mapping == MAP_FAILED) {
+		return nullptr;
+	}
+	auto* base = static_cast<std::uint8_t*>(mapping);
+	if (slack == 0) {
+		return base;
+	}
+	auto* aligned = reinterpret_cast<std::uint8_t*>(
+		(reinterpret_cast<std::uintptr_t>(base) + slack - 1) & ~(slack - 1)
+	);
+	if (aligned != base) {
+		munmap(base, aligned - base);
+	}
+	if (auto tail = base + slack - aligned) {
+		munmap(aligned + size, tail);
+	}
+	return aligned;
+}
+
+// a memory of new_huge_page_memory, private anonymous memory that is made
+// accessible as it grows
+struct huge_page_memory {
+	std::uint8_t* base;
+	std::size_t size, reservation, guard;
+
+	static std::uint8_t*
+	get(void* env, std::size_t* byte_size, std::size_t* maximum_byte_size) {
+		auto* memory = static_cast<huge_page_memory*>(env);
+		*byte_size = memory->size;
+		*maximum_byte_size = memory->reservation;
+		return memory->base;
+	}
+
+	static wasmtime_error_t* grow(void* env, std::size_t new_size) {
+		auto* memory = static_cast<huge_page_memory*>(env);
+		if (new_size > memory->reservation) {
+			return wasmtime_error_new("memory grows beyond its reservation");
+		}
+		if (mprotect(memory->base + memory->size, new_size - memory->size,
+		             PROT_READ | PROT_WRITE) != 0) {
+			return wasmtime_error_new(std::strerror(errno));
+		}
+		memory->size = new_size;
+		return nullptr;
+	}
+
+	static void finalize(void* env) {
+		auto* memory = static_cast<huge_page_memory*>(env);
+		munmap(memory->base, memory->reservation + memory->guard);
+		delete memory;
+	}
+};
+
+inline wasmtime_error_t* new_huge_page_memory(
+	void* /*env*/, const wasm_memorytype_t* /*type*/, std::size_t minimum,
+	std::size_t maximum, std::size_t reserved_size, std::size_t guard_size,
+	wasmtime_linear_memory_t* result
+) {
+	// dynamic memories come without reservation, wasm32 memories never
+	// exceed 4GB
+	const auto reservation = reserved_size
+	                             ? reserved_size
+	                             : std::min<std::size_t>(maximum, 1ul << 32);
+	auto* base = reserve_address_space(reservation + guard_size);
+	if (!base) {
+		return wasmtime_error_new(std::strerror(errno));
+	}
+	// the advice sticks to the range when parts of it become accessible
+	advise_huge_pages(base, reservation);
+
+	auto* memory = new huge_page_memory{base, 0, reservation, guard_size};
+	if (auto* error = huge_page_memory::grow(memory, minimum)) {
+		huge_page_memory::finalize(memory);
+		return error;
+	}
+	*result = {
+		memory, huge_page_memory::get, huge_page_memory::grow,
+		huge_page_memory::finalize};
+	return nullptr;
+}
+
+inline void use_huge_page_memories(wasmtime::Config& config) {
+	wasmtime_memory_creator_t creator{nullptr, new_huge_page_memory, nullptr};
+	wasmtime_config_host_memory_creator_set(config.capi(), &creator);
+}
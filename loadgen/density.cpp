@@ -0,0 +1,416 @@
+
+// cold start and instance density of a runtime. the runtime is started as a
+// child process in a scratch directory whose functions/ holds --modules links
+// to --module, served as /f0, /f1, ...
+//
+// cold start: time from the exec of the runtime to its first successful
+// response, --runs times for every module count in --modules.
+// density: for every value of --concurrency, that many clients send requests
+// back to back for --duration seconds, so about as many instances are in
+// flight at any time. the resident set size of the runtime is sampled
+// throughout, its growth over the idle runtime divided by the concurrency
+// estimates the memory overhead of an instance.
+//
+// usage: density --server "COMMAND ARGS" [--name value]..., see defaults in
+// main. the command is split at spaces and runs in the scratch directory, so
+// the binary is best given as absolute path. its output goes to runtime.log
+// there. one CSV row is printed per measurement.
+
+#include "histogram.hpp"
+#include "http_request.hpp"
+#include "options.hpp"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+using clock_type = std::chrono::steady_clock;
+
+// a directory with functions/f0.wat, functions/f1.wat, ... linking to module,
+// removed on destruction
+class scratch_directory {
+public:
+	scratch_directory(const fs::path& module, std::size_t count) {
+		auto name = (fs::temp_directory_path() / "density.XXXXXX").string();
+		if (!mkdtemp(name.data())) {
+			throw std::runtime_error{
+				std::string{"mkdtemp: "} + std::strerror(errno)};
+		}
+		path_ = name;
+		fs::create_directory(path_ / "functions");
+		const auto target = fs::absolute(module);
+		for (std::size_t i = 0; i < count; ++i) {
+			fs::create_symlink(
+				target, path_ / "functions" / ("f" + std::to_string(i) + ".wat")
+			);
+		}
+	}
+
+	scratch_directory(const scratch_directory&) = delete;
+	scratch_directory& operator=(const scratch_directory&) = delete;
+
+	~scratch_directory() {
+		std::error_code ec;
+		fs::remove_all(path_, ec);
+	}
+
+	const fs::path& path() const { return path_; }
+
+private:
+	fs::path path_;
+};
+
+// the runtime under test, killed on destruction
+class runtime_process {
+public:
+	runtime_process(
+		const std::vector<std::string>& command, const fs::path& directory
+	) {
+		std::vector<char*> argv;
+		for (const auto& arg : command) {
+			argv.push_back(const_cast<char*>(arg.c_str()));
+		}
+		argv.push_back(nullptr);
+		const auto log = (directory / "runtime.log").string();
+
+		pid_ = fork();
+		if (pid_ < 0) {
+			throw std::runtime_error{
+				std::string{"fork: "} + std::strerror(errno)};
+		}
+		if (pid_ == 0) {
+			// only async signal safe calls until exec
+			const auto fd =
+				open(log.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+			if (fd < 0 or chdir(directory.c_str()) != 0) {
+				_exit(127);
+			}
+			dup2(fd, STDOUT_FILENO);
+			dup2(fd, STDERR_FILENO);
+			execvp(argv[0], argv.data());
+			_exit(127);
+		}
+	}
+
+	runtime_process(const runtime_process&) = delete;
+	runtime_process& operator=(const runtime_process&) = delete;
+
+	~runtime_process() {
+		kill(pid_, SIGKILL);
+		waitpid(pid_, nullptr, 0);
+	}
+
+	pid_t pid() const { return pid_; }
+
+	bool exited() const {
+		int status;
+		return waitpid(pid_, &status, WNOHANG) == pid_;
+	}
+
+private:
+	pid_t pid_;
+};
+
+// resident set size of a process in kB
+std::uint64_t resident_kb(pid_t pid) {
+	std::ifstream status{"/proc/" + std::to_string(pid) + "/status"};
+	for (std::string line; std::getline(status, line);) {
+		if (line.starts_with("VmRSS:")) {
+			return std::stoull(line.substr(6));
+		}
+	}
+	return 0;
+}
+
+// a single POST with the blocking api, 0 if it did not complete
+unsigned post_once(
+	net::io_context& ioc, tcp::endpoint endpoint, const std::string& target
+) {
+	tcp::socket socket{ioc};
+	beast::error_code ec;
+	socket.connect(endpoint, ec);
+	if (ec) {
+		return 0;
+	}
+	http::request<http::string_body> request{http::verb::post, target, 11};
+	request.set(http::field::host, endpoint.address().to_string());
+	request.prepare_payload();
+	http::write(socket, request, ec);
+	if (ec) {
+		return 0;
+	}
+	beast::flat_buffer buffer;
+	http::response<http::string_body> response;
+	http::read(socket, buffer, response, ec);
+	return ec ? 0 : response.result_int();
+}
+
+// polls the runtime every millisecond until it answers target successfully
+void wait_until_ready(
+	const runtime_process& runtime, tcp::endpoint endpoint,
+	const std::string& target
+) {
+	net::io_context ioc;
+	const auto deadline = clock_type::now() + std::chrono::minutes(5);
+	while (post_once(ioc, endpoint, target) != 200) {
+		if (runtime.exited()) {
+			throw std::runtime_error{"runtime exited, see runtime.log"};
+		}
+		if (clock_type::now() > deadline) {
+			throw std::runtime_error{"runtime did not become ready"};
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+}
+
+// clients that each send their next request as soon as the previous one
+// completed, until end
+class closed_loop : public std::enable_shared_from_this<closed_loop> {
+public:
+	closed_loop(
+		net::io_context& ioc, tcp::endpoint endpoint, std::string target,
+		std::shared_ptr<const std::string> body, clock_type::time_point end,
+		latency_histogram& latencies
+	)
+		: ioc_(ioc), endpoint_(endpoint), target_(std::move(target)),
+		  body_(std::move(body)), end_(end), latencies_(latencies) {}
+
+	void start(std::size_t clients) {
+		for (std::size_t c = 0; c < clients; ++c) {
+			send();
+		}
+	}
+
+	std::uint64_t errors() const { return errors_; }
+
+private:
+	net::io_context& ioc_;
+	tcp::endpoint endpoint_;
+	std::string target_;
+	std::shared_ptr<const std::string> body_;
+	clock_type::time_point end_;
+	latency_histogram& latencies_;
+	std::atomic<std::uint64_t> errors_ = 0;
+
+	void send() {
+		const auto sent = clock_type::now();
+		if (sent >= end_) {
+			return;
+		}
+		std::make_shared<http_request>(
+			ioc_.get_executor(), endpoint_, target_, body_,
+			[self = shared_from_this(),
+		     sent](beast::error_code ec, unsigned status) {
+				if (ec or status != 200) {
+					++self->errors_;
+				} else {
+					self->latencies_.record(
+						std::chrono::nanoseconds(clock_type::now() - sent)
+							.count()
+					);
+				}
+				self->send();
+			}
+		)->start();
+	}
+};
+
+// one row per measurement, columns that do not apply to it stay empty
+struct row {
+	std::string label, measurement;
+	std::size_t modules = 0;
+	std::optional<std::size_t> run, concurrency;
+	std::optional<double> cold_start_ms;
+	std::uint64_t rss_kb = 0;
+	// density only
+	std::optional<std::uint64_t> peak_rss_kb;
+	const latency_histogram* latencies = nullptr;
+	std::uint64_t errors = 0;
+	double seconds = 0;
+
+	static void csv_header(std::ostream& out) {
+		out << "label,measurement,modules,run,concurrency,cold_start_ms,"
+			   "rss_kb,peak_rss_kb,per_instance_kb,completed,errors,"
+			   "throughput,p50_us,p99_us\n";
+	}
+
+	void csv(std::ostream& out) const {
+		auto optional = [&](const auto& value) {
+			out << ',';
+			if (value) {
+				out << *value;
+			}
+		};
+		out << label << ',' << measurement << ',' << modules;
+		optional(run);
+		optional(concurrency);
+		optional(cold_start_ms);
+		out << ',' << rss_kb;
+		optional(peak_rss_kb);
+		if (!latencies) {
+			out << ",,,,,,\n";
+			return;
+		}
+		out << ','
+			<< (double(*peak_rss_kb) - double(rss_kb)) / double(*concurrency)
+			<< ',' << latencies->count() << ',' << errors << ','
+			<< latencies->count() / seconds << ','
+			<< latencies->percentile(0.5) / 1e3 << ','
+			<< latencies->percentile(0.99) / 1e3 << '\n';
+	}
+};
+
+int main(int argc, char* argv[]) {
+	try {
+		const auto options = parse_options(
+			argc, argv,
+			{{"server", ""},
+		     {"module", "functions/noop.wat"},
+		     {"modules", "1,10,100,1000"},
+		     {"runs", "5"},
+		     {"concurrency", "1,10,100,1000,2000,4000"},
+		     {"duration", "10"},
+		     {"size", "0"},
+		     {"host", "127.0.0.1"},
+		     {"port", "32425"},
+		     {"threads", std::to_string(std::thread::hardware_concurrency())},
+		     // name of the runtime under test, copied into every row
+		     {"label", ""}}
+		);
+		if (options.at("server").empty()) {
+			throw std::invalid_argument{"--server is required"};
+		}
+
+		const auto command = split(options.at("server"), ' ');
+		const fs::path module = options.at("module");
+		const tcp::endpoint endpoint{
+			net::ip::make_address(options.at("host")),
+			static_cast<unsigned short>(std::stoi(options.at("port")))};
+		const auto runs = std::stoul(options.at("runs"));
+		const auto duration = std::chrono::duration<double>(
+			std::stod(options.at("duration"))
+		);
+		const auto thread_count = std::stoi(options.at("threads"));
+		const auto body = std::make_shared<const std::string>(
+			std::stoull(options.at("size")), 'a'
+		);
+		const auto& label = options.at("label");
+
+		// every in flight request holds a connection in both processes, the
+		// runtime inherits the limit
+		rlimit files;
+		getrlimit(RLIMIT_NOFILE, &files);
+		files.rlim_cur = files.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &files);
+
+		row::csv_header(std::cout);
+
+		for (const auto& count : split(options.at("modules"), ',')) {
+			const scratch_directory directory{module, std::stoul(count)};
+			for (std::size_t run = 0; run < runs; ++run) {
+				const auto start = clock_type::now();
+				const runtime_process runtime{command, directory.path()};
+				wait_until_ready(runtime, endpoint, "/f0");
+				const std::chrono::duration<double, std::milli> cold_start =
+					clock_type::now() - start;
+
+				const row r{
+					.label = label,
+					.measurement = "cold_start",
+					.modules = std::stoul(count),
+					.run = run,
+					.concurrency = std::nullopt,
+					.cold_start_ms = cold_start.count(),
+					.rss_kb = resident_kb(runtime.pid()),
+					.peak_rss_kb = std::nullopt,
+					.latencies = nullptr,
+					.errors = 0,
+					.seconds = 0};
+				r.csv(std::cout);
+			}
+		}
+
+		const scratch_directory directory{module, 1};
+		const runtime_process runtime{command, directory.path()};
+		wait_until_ready(runtime, endpoint, "/f0");
+		for (const auto& clients : split(options.at("concurrency"), ',')) {
+			// let connections of the previous step close
+			std::this_thread::sleep_for(std::chrono::seconds(1));
+			const auto idle_kb = resident_kb(runtime.pid());
+
+			std::atomic<bool> sampling = true;
+			std::atomic<std::uint64_t> peak_kb = idle_kb;
+			std::thread sampler{[&] {
+				while (sampling) {
+					peak_kb = std::max<std::uint64_t>(
+						peak_kb, resident_kb(runtime.pid())
+					);
+					std::this_thread::sleep_for(std::chrono::milliseconds(10));
+				}
+			}};
+
+			latency_histogram latencies;
+			net::io_context ioc{thread_count};
+			const auto start = clock_type::now();
+			auto load = std::make_shared<closed_loop>(
+				ioc, endpoint, "/f0", body,
+				start + std::chrono::duration_cast<clock_type::duration>(
+							duration
+						),
+				latencies
+			);
+			load->start(std::stoul(clients));
+
+			std::vector<std::thread> workers;
+			for (auto i = 0; i < thread_count - 1; ++i) {
+				workers.emplace_back([&ioc] { ioc.run(); });
+			}
+			ioc.run();
+			for (auto& worker : workers) {
+				worker.join();
+			}
+			const std::chrono::duration<double> seconds =
+				clock_type::now() - start;
+			sampling = false;
+			sampler.join();
+
+			const row r{
+				.label = label,
+				.measurement = "density",
+				.modules = 1,
+				.run = std::nullopt,
+				.concurrency = std::stoul(clients),
+				.cold_start_ms = std::nullopt,
+				.rss_kb = idle_kb,
+				.peak_rss_kb = peak_kb.load(),
+				.latencies = &latencies,
+				.errors = load->errors(),
+				.seconds = seconds.count()};
+			r.csv(std::cout);
+		}
+	} catch (std::exception const& e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
@@ -0,0 +1,88 @@
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// log-linear histogram in the spirit of HdrHistogram. values are bucketed by
+// their highest set bit and then linearly into 2^precision sub buckets, so a
+// reported value is at most 2^-precision above the recorded one. recording is
+// lock free and may happen from any number of threads.
+class latency_histogram {
+public:
+	explicit latency_histogram(int precision = 7)
+		: precision_(precision),
+		  counts_((std::size_t(65 - precision) << precision)) {}
+
+	void record(std::uint64_t value) {
+		counts_[index(value)].fetch_add(1, std::memory_order_relaxed);
+		count_.fetch_add(1, std::memory_order_relaxed);
+		sum_.fetch_add(value, std::memory_order_relaxed);
+		auto max = max_.load(std::memory_order_relaxed);
+		while (value > max and
+		       !max_.compare_exchange_weak(max, value, std::memory_order_relaxed)
+		) {
+		}
+	}
+
+	// adds the values recorded in other, which needs the same precision
+	void merge(const latency_histogram& other) {
+		for (std::size_t idx = 0; idx < counts_.size(); ++idx) {
+			counts_[idx] += other.counts_[idx];
+		}
+		count_ += other.count_;
+		sum_ += other.sum_;
+		if (other.max_ > max_) {
+			max_ = other.max_.load();
+		}
+	}
+
+	std::uint64_t count() const { return count_; }
+	std::uint64_t max() const { return max_; }
+	double mean() const { return count_ ? double(sum_) / count_ : 0; }
+
+	// highest value equivalent to the one below which the fraction p of all
+	// recorded values lie
+	std::uint64_t percentile(double p) const {
+		const auto rank = std::max<std::uint64_t>(1, p * count_ + 0.5);
+		std::uint64_t seen = 0;
+		for (std::size_t idx = 0; idx < counts_.size(); ++idx) {
+			seen += counts_[idx];
+			if (seen >= rank) {
+				return std::min<std::uint64_t>(highest_equivalent(idx), max_);
+			}
+		}
+		return max_;
+	}
+
+private:
+	int precision_;
+	std::vector<std::atomic<std::uint64_t>> counts_;
+	std::atomic<std::uint64_t> count_ = 0, sum_ = 0, max_ = 0;
+
+	// values below 2^precision have a bucket of their own, every following
+	// power of two range is split into 2^precision buckets
+	std::size_t index(std::uint64_t value) const {
+		const auto sub_buckets = std::uint64_t(1) << precision_;
+		if (value < sub_buckets) {
+			return value;
+		}
+		const int shift = std::bit_width(value) - 1 - precision_;
+		return ((shift + 1) << precision_) + (value >> shift) - sub_buckets;
+	}
+
+	std::uint64_t highest_equivalent(std::size_t idx) const {
+		const auto sub_buckets = std::size_t(1) << precision_;
+		if (idx < sub_buckets) {
+			return idx;
+		}
+		const int shift = int(idx >> precision_) - 1;
+		const auto lowest = std::uint64_t(sub_buckets + idx % sub_buckets)
+		                 << shift;
+		return lowest + (std::uint64_t(1) << shift) - 1;
+	}
+};
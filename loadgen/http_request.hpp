@@ -0,0 +1,97 @@
+
+#pragma once
+
+#include <boost/asio.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/version.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+
+namespace beast = boost::beast;   // from <boost/beast.hpp>
+namespace http = beast::http;     // from <boost/beast/http.hpp>
+namespace net = boost::asio;      // from <boost/asio.hpp>
+using tcp = boost::asio::ip::tcp; // from <boost/asio/ip/tcp.hpp>
+
+// a single POST on a connection of its own, the runtimes close every
+// connection after their response. callback receives the status code, or an
+// error code if the request did not complete.
+class http_request : public std::enable_shared_from_this<http_request> {
+public:
+	using callback_t = std::function<void(beast::error_code, unsigned status)>;
+
+	http_request(
+		net::any_io_executor executor, tcp::endpoint endpoint,
+		const std::string& target, std::shared_ptr<const std::string> body,
+		callback_t callback
+	)
+		: stream_(executor), endpoint_(endpoint), body_(std::move(body)),
+		  callback_(std::move(callback)) {
+		request_.method(http::verb::post);
+		request_.target(target);
+		request_.set(http::field::host, endpoint_.address().to_string());
+		request_.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+		request_.set(http::field::content_type, "application/octet-stream");
+		// the payload is shared by all requests, it is only ever read
+		request_.body().data = const_cast<char*>(body_->data());
+		request_.body().size = body_->size();
+		request_.body().more = false;
+		request_.content_length(body_->size());
+		response_parser_.body_limit(
+			std::numeric_limits<std::uint64_t>::max()
+		);
+	}
+
+	void start() {
+		stream_.expires_after(std::chrono::seconds(60));
+		stream_.async_connect(
+			endpoint_,
+			[self = shared_from_this()](beast::error_code ec) {
+				if (ec) {
+					return self->callback_(ec, 0);
+				}
+				self->write_request();
+			}
+		);
+	}
+
+private:
+	beast::tcp_stream stream_;
+	tcp::endpoint endpoint_;
+	std::shared_ptr<const std::string> body_;
+	callback_t callback_;
+
+	beast::flat_buffer buffer_{8192};
+	http::request<http::buffer_body> request_;
+	http::response_parser<http::string_body> response_parser_;
+
+	void write_request() {
+		http::async_write(
+			stream_, request_,
+			[self = shared_from_this()](beast::error_code ec, std::size_t) {
+				if (ec) {
+					return self->callback_(ec, 0);
+				}
+				self->read_response();
+			}
+		);
+	}
+
+	void read_response() {
+		http::async_read(
+			stream_, buffer_, response_parser_,
+			[self = shared_from_this()](beast::error_code ec, std::size_t) {
+				if (ec) {
+					return self->callback_(ec, 0);
+				}
+				self->stream_.socket().shutdown(tcp::socket::shutdown_both, ec);
+				self->callback_({}, self->response_parser_.get().result_int());
+			}
+		);
+	}
+};
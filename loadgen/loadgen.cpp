@@ -0,0 +1,181 @@
+
+// open loop load generator. requests are sent at a fixed arrival rate no
+// matter how fast the runtime answers, and latency is measured from the time a
+// request was supposed to be sent. closed loop tools like wrk wait for a
+// response before sending the next request, so a stalled runtime also stalls
+// the load and the queueing delay never shows up in the latencies.
+//
+// usage: loadgen [--name value]..., see defaults in main. for every
+// combination of --paths and --sizes one row of results is printed.
+
+#include "histogram.hpp"
+#include "http_request.hpp"
+#include "options.hpp"
+#include "report.hpp"
+#include "request_limiter.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using clock_type = std::chrono::steady_clock;
+
+// sends count requests, the i-th one at start + i / rate. at most connections
+// requests are in flight, the others queue up in order of their send time.
+class open_loop : public std::enable_shared_from_this<open_loop> {
+public:
+	open_loop(
+		net::io_context& ioc, tcp::endpoint endpoint, std::string target,
+		std::shared_ptr<const std::string> body, double rate,
+		std::uint64_t count, std::size_t connections,
+		latency_histogram& latencies
+	)
+		: ioc_(ioc), timer_(ioc), endpoint_(endpoint),
+		  target_(std::move(target)), body_(std::move(body)), rate_(rate),
+		  count_(count), latencies_(latencies), limiter_(connections) {}
+
+	void start() {
+		start_ = clock_type::now();
+		schedule(0);
+	}
+
+	std::uint64_t errors() const { return errors_; }
+
+private:
+	net::io_context& ioc_;
+	net::steady_timer timer_;
+	tcp::endpoint endpoint_;
+	std::string target_;
+	std::shared_ptr<const std::string> body_;
+	double rate_;
+	std::uint64_t count_;
+	latency_histogram& latencies_;
+
+	clock_type::time_point start_;
+	request_limiter limiter_;
+	std::atomic<std::uint64_t> errors_ = 0;
+
+	clock_type::time_point intended(std::uint64_t i) const {
+		return start_ + std::chrono::duration_cast<clock_type::duration>(
+							std::chrono::duration<double>(i / rate_)
+						);
+	}
+
+	void schedule(std::uint64_t i) {
+		if (i == count_) {
+			return;
+		}
+		timer_.expires_at(intended(i));
+		timer_.async_wait([self = shared_from_this(),
+		                   i](boost::system::error_code ec) {
+			if (ec) {
+				return;
+			}
+			// a late timer does not shift the schedule, every request that is
+			// due is sent and still measured from its intended time
+			auto next = i;
+			do {
+				self->limiter_.submit([self, intended = self->intended(next)] {
+					self->send(intended);
+				});
+				++next;
+			} while (next < self->count_ and
+			         self->intended(next) <= clock_type::now());
+			self->schedule(next);
+		});
+	}
+
+	void send(clock_type::time_point intended) {
+		std::make_shared<http_request>(
+			ioc_.get_executor(), endpoint_, target_, body_,
+			[self = shared_from_this(),
+		     intended](beast::error_code ec, unsigned status) {
+				if (ec or status != 200) {
+					++self->errors_;
+				} else {
+					self->latencies_.record(
+						std::chrono::nanoseconds(clock_type::now() - intended)
+							.count()
+					);
+				}
+				self->limiter_.release();
+			}
+		)->start();
+	}
+};
+
+int main(int argc, char* argv[]) {
+	try {
+		const auto options = parse_options(
+			argc, argv,
+			{{"host", "127.0.0.1"},
+		     {"port", "32425"},
+		     // requests per second and seconds per combination of path and size
+		     {"rate", "100"},
+		     {"duration", "10"},
+		     {"connections", "64"},
+		     {"threads", std::to_string(std::thread::hardware_concurrency())},
+		     // comma separated
+		     {"paths", "/echo"},
+		     {"sizes", "0,2000000"},
+		     // name of the runtime under test, copied into every row
+		     {"label", ""},
+		     // csv or json
+		     {"format", "csv"}}
+		);
+
+		const tcp::endpoint endpoint{
+			net::ip::make_address(options.at("host")),
+			static_cast<unsigned short>(std::stoi(options.at("port")))};
+		const auto rate = std::stod(options.at("rate"));
+		const auto duration = std::stod(options.at("duration"));
+		const auto connections = std::stoul(options.at("connections"));
+		const auto thread_count = std::stoi(options.at("threads"));
+		const auto& format = options.at("format");
+
+		if (format == "csv") {
+			report::csv_header(std::cout);
+		}
+		for (const auto& path : split(options.at("paths"), ',')) {
+			for (const auto& size : split(options.at("sizes"), ',')) {
+				const auto body =
+					std::make_shared<const std::string>(std::stoul(size), 'a');
+
+				net::io_context ioc{thread_count};
+				latency_histogram latencies;
+				auto load = std::make_shared<open_loop>(
+					ioc, endpoint, path, body, rate,
+					std::uint64_t(rate * duration), connections, latencies
+				);
+				const auto start = clock_type::now();
+				load->start();
+
+				std::vector<std::thread> workers;
+				for (auto i = 0; i < thread_count - 1; ++i) {
+					workers.emplace_back([&ioc] { ioc.run(); });
+				}
+				ioc.run();
+				for (auto& worker : workers) {
+					worker.join();
+				}
+				const std::chrono::duration<double> seconds =
+					clock_type::now() - start;
+
+				print_report(
+					{options.at("label"), path, size, rate, connections,
+				     load->errors(), seconds.count(), latencies},
+					format
+				);
+			}
+		}
+	} catch (std::exception const& e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
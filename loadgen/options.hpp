@@ -0,0 +1,37 @@
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// command line of the form --name value ..., names not given keep the value
+// in defaults
+inline std::unordered_map<std::string, std::string> parse_options(
+	int argc, char* argv[],
+	std::unordered_map<std::string, std::string> defaults
+) {
+	for (auto i = 1; i < argc; i += 2) {
+		std::string_view name = argv[i];
+		if (!name.starts_with("--") or i + 1 == argc or
+		    !defaults.contains(std::string{name.substr(2)})) {
+			throw std::invalid_argument{"unknown option " + std::string{name}};
+		}
+		defaults[std::string{name.substr(2)}] = argv[i + 1];
+	}
+	return defaults;
+}
+
+inline std::vector<std::string> split(std::string_view list, char separator) {
+	std::vector<std::string> result;
+	for (std::size_t begin = 0; begin <= list.size();) {
+		auto end = std::min(list.find(separator, begin), list.size());
+		result.emplace_back(list.substr(begin, end - begin));
+		begin = end + 1;
+	}
+	return result;
+}
@@ -0,0 +1,280 @@
+
+// replays a trace of invocations against a runtime. the trace is a JSONL file
+// with one invocation per line:
+//   {"time": 0.25, "path": "/compute", "size": 0}
+//   {"time": 0.26, "path": "/echo", "payload": "hello"}
+//   {"path": "/reverse", "size": 2000000, "session": "a", "think": 0.1}
+// time is the offset of the invocation from the start of the trace in seconds.
+// the body is either payload or size bytes. invocations of the same session
+// are sent in trace order, no earlier than think seconds after the previous
+// invocation of their session completed, which models clients waiting for
+// a response. --speed scales all times, 2 replays twice as fast.
+//
+// usage: replay --trace FILE [--name value]..., see defaults in main. one row
+// of results is printed per function path and one for all of them together.
+
+#include "histogram.hpp"
+#include "http_request.hpp"
+#include "options.hpp"
+#include "report.hpp"
+#include "request_limiter.hpp"
+#include <boost/json.hpp>
+#include <boost/json/src.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace json = boost::json;
+
+using clock_type = std::chrono::steady_clock;
+
+struct invocation {
+	double time = 0;
+	std::string path;
+	std::shared_ptr<const std::string> body;
+	std::optional<double> think;
+};
+
+// invocations that are sent one after the other, either those of a session or
+// a single invocation without one
+using chain = std::vector<invocation>;
+
+struct path_results {
+	latency_histogram latencies;
+	std::atomic<std::uint64_t> errors = 0;
+};
+
+std::vector<chain> read_trace(const std::string& path) {
+	std::ifstream in{path};
+	if (!in) {
+		throw std::runtime_error{"could not open trace " + path};
+	}
+
+	std::vector<chain> chains;
+	std::unordered_map<std::string, std::size_t> sessions;
+	// equal sizes share their body
+	std::unordered_map<std::uint64_t, std::shared_ptr<const std::string>>
+		bodies;
+	for (std::string line; std::getline(in, line);) {
+		if (line.empty()) {
+			continue;
+		}
+		const auto object = json::parse(line).as_object();
+
+		invocation entry;
+		if (auto* time = object.if_contains("time")) {
+			entry.time = time->to_number<double>();
+		}
+		entry.path = json::value_to<std::string>(object.at("path"));
+		if (auto* payload = object.if_contains("payload")) {
+			entry.body = std::make_shared<const std::string>(
+				json::value_to<std::string>(*payload)
+			);
+		} else {
+			const auto size = object.at("size").to_number<std::uint64_t>();
+			auto& body = bodies[size];
+			if (!body) {
+				body = std::make_shared<const std::string>(size, 'a');
+			}
+			entry.body = body;
+		}
+		if (auto* think = object.if_contains("think")) {
+			entry.think = think->to_number<double>();
+		}
+
+		if (auto* session = object.if_contains("session")) {
+			auto [it, inserted] = sessions.try_emplace(
+				json::value_to<std::string>(*session), chains.size()
+			);
+			if (inserted) {
+				chains.emplace_back();
+			}
+			chains[it->second].push_back(std::move(entry));
+		} else {
+			chains.push_back({std::move(entry)});
+		}
+	}
+	return chains;
+}
+
+class replay : public std::enable_shared_from_this<replay> {
+public:
+	replay(
+		net::io_context& ioc, tcp::endpoint endpoint,
+		const std::vector<chain>& chains, double speed,
+		std::size_t connections,
+		std::map<std::string, std::unique_ptr<path_results>>& results
+	)
+		: ioc_(ioc), endpoint_(endpoint), chains_(chains), speed_(speed),
+		  limiter_(connections), results_(results) {}
+
+	void start() {
+		start_ = clock_type::now();
+		for (std::size_t c = 0; c < chains_.size(); ++c) {
+			schedule(c, 0, clock_type::time_point{});
+		}
+	}
+
+private:
+	net::io_context& ioc_;
+	tcp::endpoint endpoint_;
+	const std::vector<chain>& chains_;
+	double speed_;
+	request_limiter limiter_;
+	std::map<std::string, std::unique_ptr<path_results>>& results_;
+	clock_type::time_point start_;
+
+	clock_type::time_point at(double seconds) const {
+		return start_ + std::chrono::duration_cast<clock_type::duration>(
+							std::chrono::duration<double>(seconds / speed_)
+						);
+	}
+
+	// sends invocation i of chain c at its time in the trace, or think time
+	// after the previous invocation of the chain completed if that is later
+	void schedule(
+		std::size_t c, std::size_t i, clock_type::time_point previous_completed
+	) {
+		if (i == chains_[c].size()) {
+			return;
+		}
+		const auto& entry = chains_[c][i];
+		auto intended = at(entry.time);
+		if (entry.think) {
+			intended = std::max(
+				intended,
+				previous_completed +
+					std::chrono::duration_cast<clock_type::duration>(
+						std::chrono::duration<double>(*entry.think / speed_)
+					)
+			);
+		}
+
+		auto timer = std::make_shared<net::steady_timer>(ioc_, intended);
+		timer->async_wait([self = shared_from_this(), timer, c, i,
+		                   intended](boost::system::error_code ec) {
+			if (ec) {
+				return;
+			}
+			self->limiter_.submit([self, c, i, intended] {
+				self->send(c, i, intended);
+			});
+		});
+	}
+
+	void send(std::size_t c, std::size_t i, clock_type::time_point intended) {
+		const auto& entry = chains_[c][i];
+		std::make_shared<http_request>(
+			ioc_.get_executor(), endpoint_, entry.path, entry.body,
+			[self = shared_from_this(), c, i,
+		     intended](beast::error_code ec, unsigned status) {
+				const auto completed = clock_type::now();
+				auto& results = *self->results_.at(self->chains_[c][i].path);
+				if (ec or status != 200) {
+					++results.errors;
+				} else {
+					results.latencies.record(
+						std::chrono::nanoseconds(completed - intended).count()
+					);
+				}
+				self->limiter_.release();
+				self->schedule(c, i + 1, completed);
+			}
+		)->start();
+	}
+};
+
+int main(int argc, char* argv[]) {
+	try {
+		const auto options = parse_options(
+			argc, argv,
+			{{"trace", ""},
+		     {"host", "127.0.0.1"},
+		     {"port", "32425"},
+		     {"speed", "1"},
+		     {"connections", "64"},
+		     {"threads", std::to_string(std::thread::hardware_concurrency())},
+		     // name of the runtime under test, copied into every row
+		     {"label", ""},
+		     // csv or json
+		     {"format", "csv"}}
+		);
+
+		const tcp::endpoint endpoint{
+			net::ip::make_address(options.at("host")),
+			static_cast<unsigned short>(std::stoi(options.at("port")))};
+		const auto speed = std::stod(options.at("speed"));
+		const auto connections = std::stoul(options.at("connections"));
+		const auto thread_count = std::stoi(options.at("threads"));
+		const auto& format = options.at("format");
+
+		const auto chains = read_trace(options.at("trace"));
+		std::map<std::string, std::unique_ptr<path_results>> results;
+		std::uint64_t invocations = 0;
+		double trace_seconds = 0;
+		for (const auto& chain : chains) {
+			for (const auto& entry : chain) {
+				results.try_emplace(
+					entry.path, std::make_unique<path_results>()
+				);
+				++invocations;
+				trace_seconds = std::max(trace_seconds, entry.time);
+			}
+		}
+
+		net::io_context ioc{thread_count};
+		auto load = std::make_shared<replay>(
+			ioc, endpoint, chains, speed, connections, results
+		);
+		const auto start = clock_type::now();
+		load->start();
+
+		std::vector<std::thread> workers;
+		for (auto i = 0; i < thread_count - 1; ++i) {
+			workers.emplace_back([&ioc] { ioc.run(); });
+		}
+		ioc.run();
+		for (auto& worker : workers) {
+			worker.join();
+		}
+		const std::chrono::duration<double> seconds = clock_type::now() - start;
+
+		// offered rate of the trace, ignoring think times
+		const auto offered_rate =
+			trace_seconds > 0 ? invocations * speed / trace_seconds : 0;
+		if (format == "csv") {
+			report::csv_header(std::cout);
+		}
+		latency_histogram all;
+		std::uint64_t all_errors = 0;
+		for (const auto& [path, result] : results) {
+			print_report(
+				{options.at("label"), path, "trace", offered_rate, connections,
+			     result->errors, seconds.count(), result->latencies},
+				format
+			);
+			all.merge(result->latencies);
+			all_errors += result->errors;
+		}
+		print_report(
+			{options.at("label"), "all", "trace", offered_rate, connections,
+		     all_errors, seconds.count(), all},
+			format
+		);
+	} catch (std::exception const& e) {
+		std::cerr << "Error: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+}
@@ -0,0 +1,64 @@
+
+#pragma once
+
+#include "histogram.hpp"
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+// one row of results. latencies are in microseconds and, for open loop runs,
+// measured from the time a request was supposed to be sent, so they include
+// the time it queued behind earlier ones.
+struct report {
+	std::string label, path, size;
+	double offered_rate;
+	std::size_t connections;
+	std::uint64_t errors;
+	double seconds;
+	const latency_histogram& latencies;
+
+	static void csv_header(std::ostream& out) {
+		out << "label,path,size,offered_rate,connections,completed,errors,"
+			   "throughput,mean_us,p50_us,p90_us,p99_us,p999_us,p9999_us,"
+			   "max_us\n";
+	}
+
+	void csv(std::ostream& out) const {
+		out << label << ',' << path << ',' << size << ',' << offered_rate << ','
+			<< connections << ',' << latencies.count() << ',' << errors << ','
+			<< latencies.count() / seconds << ',' << latencies.mean() / 1e3;
+		for (auto p : percentiles) {
+			out << ',' << latencies.percentile(p) / 1e3;
+		}
+		out << ',' << latencies.max() / 1e3 << '\n';
+	}
+
+	// one object per line
+	void json(std::ostream& out) const {
+		out << R"({"label":")" << label << R"(","path":")" << path
+			<< R"(","size":")" << size << R"(","offered_rate":)"
+			<< offered_rate << R"(,"connections":)" << connections
+			<< R"(,"completed":)" << latencies.count() << R"(,"errors":)"
+			<< errors << R"(,"throughput":)" << latencies.count() / seconds
+			<< R"(,"mean_us":)" << latencies.mean() / 1e3;
+		for (auto i = 0; i < 5; ++i) {
+			out << ",\"" << percentile_names[i]
+				<< "_us\":" << latencies.percentile(percentiles[i]) / 1e3;
+		}
+		out << R"(,"max_us":)" << latencies.max() / 1e3 << "}\n";
+	}
+
+private:
+	static constexpr double percentiles[] = {0.5, 0.9, 0.99, 0.999, 0.9999};
+	static constexpr const char* percentile_names[] = {
+		"p50", "p90", "p99", "p999", "p9999"};
+};
+
+inline void print_report(const report& r, const std::string& format) {
+	if (format == "json") {
+		r.json(std::cout);
+	} else {
+		r.csv(std::cout);
+	}
+}
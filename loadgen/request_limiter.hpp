@@ -0,0 +1,49 @@
+
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+// limits the number of requests in flight to the number of connections, the
+// others wait in the order they were submitted
+class request_limiter {
+public:
+	explicit request_limiter(std::size_t connections)
+		: connections_(connections) {}
+
+	// start is run once a connection is free, the request it starts has to
+	// call release when it completed
+	void submit(std::function<void()> start) {
+		{
+			std::lock_guard lock{mutex_};
+			if (in_flight_ == connections_) {
+				pending_.push_back(std::move(start));
+				return;
+			}
+			++in_flight_;
+		}
+		start();
+	}
+
+	void release() {
+		std::function<void()> next;
+		{
+			std::lock_guard lock{mutex_};
+			if (pending_.empty()) {
+				--in_flight_;
+				return;
+			}
+			next = std::move(pending_.front());
+			pending_.pop_front();
+		}
+		next();
+	}
+
+private:
+	std::size_t connections_;
+	std::mutex mutex_;
+	std::size_t in_flight_ = 0;
+	std::deque<std::function<void()>> pending_;
+};
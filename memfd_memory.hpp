@@ -0,0 +1,254 @@
+
+// linear memories backed by a memfd instead of anonymous memory. inputs that
+// are already in a file, like request bodies spooled into a memfd_buffer, can
+// then be mapped copy on write into the guest's address range instead of being
+// copied, which costs the same for a few bytes and for gigabytes.
+//
+// wasmtime initializes the data segments of host created memories by copying
+// them, the copy on write module images it uses otherwise are not available.
+// the memfd memories are therefore opt-in with FAASHION_MAP_INPUTS.
+//
+// FAASHION_SHARED_PAYLOADS hands bodies to localities on the same host as a
+// memfd_buffer instead of sending them, see shared_payload.
+#pragma once
+
+#include "huge_pages.hpp"
+#include "wasmtime.hh"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+inline const bool map_inputs = std::getenv("FAASHION_MAP_INPUTS") != nullptr;
+
+inline const bool shared_payloads =
+	std::getenv("FAASHION_SHARED_PAYLOADS") != nullptr;
+
+inline const std::size_t page_size = sysconf(_SC_PAGESIZE);
+
+inline std::size_t round_up_to_page(std::size_t size) {
+	return (size + page_size - 1) & ~(page_size - 1);
+}
+
+inline std::runtime_error errno_error(const char* what) {
+	return std::runtime_error{std::string{what} + ": " + std::strerror(errno)};
+}
+
+// a memory of memfd_memory_creator. the whole reservation plus guard pages is
+// reserved inaccessible, the accessible part is a shared mapping of the memfd
+// that grows together with the file.
+struct memfd_memory {
+	int fd;
+	std::uint8_t* base;
+	std::size_t size, reservation, guard;
+
+	static std::uint8_t*
+	get(void* env, std::size_t* byte_size, std::size_t* maximum_byte_size) {
+		auto* memory = static_cast<memfd_memory*>(env);
+		*byte_size = memory->size;
+		*maximum_byte_size = memory->reservation;
+		return memory->base;
+	}
+
+	static wasmtime_error_t* grow(void* env, std::size_t new_size) {
+		auto* memory = static_cast<memfd_memory*>(env);
+		if (new_size > memory->reservation) {
+			return wasmtime_error_new("memory grows beyond its reservation");
+		}
+		// memories with a minimum of 0 start empty, mmap refuses 0 bytes
+		if (new_size == memory->size) {
+			return nullptr;
+		}
+		if (ftruncate(memory->fd, new_size) != 0 or
+		    mmap(memory->base + memory->size, new_size - memory->size,
+		         PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, memory->fd,
+		         memory->size) == MAP_FAILED) {
+			return wasmtime_error_new(std::strerror(errno));
+		}
+		advise_huge_pages(memory->base + memory->size, new_size - memory->size);
+		memory->size = new_size;
+		return nullptr;
+	}
+
+	static void finalize(void* env) {
+		auto* memory = static_cast<memfd_memory*>(env);
+		munmap(memory->base, memory->reservation + memory->guard);
+		close(memory->fd);
+		delete memory;
+	}
+};
+
+inline wasmtime_error_t* new_memfd_memory(
+	void* /*env*/, const wasm_memorytype_t* /*type*/, std::size_t minimum,
+	std::size_t maximum, std::size_t reserved_size, std::size_t guard_size,
+	wasmtime_linear_memory_t* result
+) {
+	// dynamic memories come without reservation, wasm32 memories never
+	// exceed 4GB
+	const auto reservation = reserved_size
+	                             ? reserved_size
+	                             : std::min<std::size_t>(maximum, 1ul << 32);
+	auto* base = reserve_address_space(reservation + guard_size);
+	if (!base) {
+		return wasmtime_error_new(std::strerror(errno));
+	}
+	const auto fd = memfd_create("wasm-memory", MFD_CLOEXEC);
+	if (fd < 0) {
+		munmap(base, reservation + guard_size);
+		return wasmtime_error_new(std::strerror(errno));
+	}
+
+	auto* memory = new memfd_memory{fd, base, 0, reservation, guard_size};
+	if (auto* error = memfd_memory::grow(memory, minimum)) {
+		memfd_memory::finalize(memory);
+		return error;
+	}
+	*result = {
+		memory, memfd_memory::get, memfd_memory::grow, memfd_memory::finalize};
+	return nullptr;
+}
+
+inline void use_memfd_memories(wasmtime::Config& config) {
+	wasmtime_memory_creator_t creator{nullptr, new_memfd_memory, nullptr};
+	wasmtime_config_host_memory_creator_set(config.capi(), &creator);
+}
+
+// maps size bytes of fd copy on write at offset into a linear memory. the
+// guest sees the file's content and its writes stay private. memory offset
+// and file offset have to be page aligned, the last page may extend beyond
+// the end of the file and reads as zeros there.
+inline void map_into(
+	std::span<std::uint8_t> memory, std::size_t offset, int fd,
+	std::size_t size
+) {
+	if (size == 0) {
+		return;
+	}
+	if (offset % page_size != 0 or offset + size > memory.size()) {
+		throw std::invalid_argument{"input does not fit into memory"};
+	}
+	if (mmap(memory.data() + offset, size, PROT_READ | PROT_WRITE,
+	         MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+		throw errno_error("mapping input");
+	}
+}
+
+// a memfd and a shared mapping of it, which request bodies are received into
+// so map_into can place them into a guest
+class memfd_buffer {
+public:
+	explicit memfd_buffer(std::size_t size)
+		: fd_(memfd_create("request-body", MFD_CLOEXEC)), size_(size) {
+		if (fd_ < 0) {
+			throw errno_error("memfd_create");
+		}
+		if (ftruncate(fd_, size_) != 0) {
+			close(fd_);
+			throw errno_error("ftruncate");
+		}
+		map();
+	}
+
+	// the memfd_buffer of another process on this host, given as its pid and
+	// the buffer's descriptor there. the file is opened through /proc, which
+	// the kernel allows to processes of the same user.
+	static memfd_buffer open_shared(int pid, int fd, std::size_t size) {
+		const auto path =
+			"/proc/" + std::to_string(pid) + "/fd/" + std::to_string(fd);
+		memfd_buffer buffer;
+		buffer.fd_ = open(path.c_str(), O_RDWR | O_CLOEXEC);
+		if (buffer.fd_ < 0) {
+			throw errno_error("opening shared payload");
+		}
+		struct stat status;
+		if (fstat(buffer.fd_, &status) != 0 or
+		    std::size_t(status.st_size) < size) {
+			throw std::runtime_error{"shared payload is too short"};
+		}
+		buffer.size_ = size;
+		buffer.map();
+		return buffer;
+	}
+
+	memfd_buffer(memfd_buffer&& other) noexcept
+		: fd_(std::exchange(other.fd_, -1)),
+		  data_(std::exchange(other.data_, nullptr)),
+		  size_(std::exchange(other.size_, 0)) {}
+
+	memfd_buffer& operator=(memfd_buffer other) noexcept {
+		std::swap(fd_, other.fd_);
+		std::swap(data_, other.data_);
+		std::swap(size_, other.size_);
+		return *this;
+	}
+
+	~memfd_buffer() {
+		if (data_) {
+			munmap(data_, size_);
+		}
+		if (fd_ >= 0) {
+			close(fd_);
+		}
+	}
+
+	int fd() const { return fd_; }
+	std::span<std::uint8_t> data() const { return {data_, size_}; }
+
+private:
+	int fd_ = -1;
+	std::uint8_t* data_ = nullptr;
+	std::size_t size_ = 0;
+
+	memfd_buffer() = default;
+
+	void map() {
+		if (size_ == 0) {
+			return;
+		}
+		auto* data =
+			mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+		if (data == MAP_FAILED) {
+			close(std::exchange(fd_, -1));
+			throw errno_error("mmap");
+		}
+		data_ = static_cast<std::uint8_t*>(data);
+		advise_huge_pages(data_, size_);
+	}
+};
+
+// a memfd_buffer handed to a process on the same host, which opens it with
+// memfd_buffer::open_shared. the sender keeps the buffer until the receiver
+// is done with it.
+struct shared_payload {
+	std::int32_t pid, fd;
+	std::uint64_t size;
+
+	template <typename Archive>
+	void serialize(Archive& ar, unsigned) {
+		ar & pid & fd & size;
+	}
+};
+
+// equal for processes that can open each other's descriptors through /proc,
+// which need to run in the same boot of a host and in the same pid namespace
+inline std::string host_identity() {
+	std::ifstream in{"/proc/sys/kernel/random/boot_id"};
+	std::string boot_id;
+	std::getline(in, boot_id);
+	char pid_namespace[64] = {};
+	readlink("/proc/self/ns/pid", pid_namespace, sizeof(pid_namespace) - 1);
+	return boot_id + ' ' + pid_namespace;
+}
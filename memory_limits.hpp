@@ -0,0 +1,170 @@
+
+// bounds on the linear memory of guests.
+//
+// FAASHION_MEMORY_LIMITS=path=memory[:table_elements],... limits the functions
+// listed, "*" the functions that are not. sizes are in bytes or have a K, M or
+// G suffix. the limits are enforced by wasmtime's store limiter, memories and
+// tables can neither be created larger nor grow beyond them.
+//
+// FAASHION_MEMORY_BUDGET bounds the sum of the memory limits of the instances
+// in flight on a node, functions without a limit count with the 4GB a wasm32
+// memory can reach. instances that would exceed it are refused, or wait until
+// enough of the budget is released if FAASHION_MEMORY_BUDGET_QUEUE is set.
+#pragma once
+
+#include "parse_size.hpp"
+#include "wasmtime.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+struct function_limits {
+	// negative values leave the limit to wasmtime, which has none
+	std::int64_t memory = -1, table_elements = -1;
+
+	// what an instance counts against the memory budget
+	std::uint64_t charge() const {
+		return memory < 0 ? std::uint64_t(4) << 30 : std::uint64_t(memory);
+	}
+
+	// the largest body an instance may be given. the function ABI passes
+	// sizes as i32, and the body has to fit into the memory next to the
+	// function's own data, which alloc reports by failing.
+	std::uint64_t max_input() const {
+		const std::uint64_t abi_max = std::numeric_limits<std::int32_t>::max();
+		return memory < 0 ? abi_max
+		                  : std::min(abi_max, std::uint64_t(memory));
+	}
+};
+
+inline const std::unordered_map<std::string, function_limits>
+	configured_limits = [] {
+		std::unordered_map<std::string, function_limits> result;
+		const auto* list = std::getenv("FAASHION_MEMORY_LIMITS");
+		for (std::string_view rest = list ? list : ""; !rest.empty();) {
+			const auto entry = rest.substr(0, rest.find(','));
+			rest.remove_prefix(std::min(rest.size(), entry.size() + 1));
+
+			const auto equals = entry.find('=');
+			if (equals == std::string_view::npos) {
+				throw std::invalid_argument{
+					"bad memory limit " + std::string{entry}};
+			}
+			const auto values = entry.substr(equals + 1);
+			const auto colon = values.find(':');
+			function_limits limits;
+			limits.memory = parse_size(values.substr(0, colon));
+			if (colon != std::string_view::npos) {
+				limits.table_elements = parse_size(values.substr(colon + 1));
+			}
+			result.emplace(entry.substr(0, equals), limits);
+		}
+		return result;
+	}();
+
+inline function_limits limits_of(const std::string& path) {
+	if (auto it = configured_limits.find(path);
+	    it != configured_limits.end()) {
+		return it->second;
+	}
+	if (auto it = configured_limits.find("*"); it != configured_limits.end()) {
+		return it->second;
+	}
+	return {};
+}
+
+inline void
+apply_limits(wasmtime::Store& store, const function_limits& limits) {
+	store.limiter(limits.memory, limits.table_elements, -1, -1, -1);
+}
+
+// the memory that instances in flight on this node may reach in total
+class memory_budget {
+public:
+	explicit memory_budget(std::uint64_t total) : total_(total) {}
+
+	bool try_acquire(std::uint64_t bytes) {
+		auto committed = committed_.load(std::memory_order_relaxed);
+		do {
+			if (bytes > total_ - committed) {
+				return false;
+			}
+		} while (!committed_.compare_exchange_weak(committed, committed + bytes)
+		);
+		return true;
+	}
+
+	void release(std::uint64_t bytes) { committed_ -= bytes; }
+
+	std::uint64_t committed() const { return committed_; }
+	std::uint64_t total() const { return total_; }
+
+private:
+	const std::uint64_t total_;
+	std::atomic<std::uint64_t> committed_ = 0;
+};
+
+inline memory_budget node_memory_budget{[] {
+	const auto* budget = std::getenv("FAASHION_MEMORY_BUDGET");
+	return budget ? std::uint64_t(parse_size(budget))
+	              : std::numeric_limits<std::uint64_t>::max();
+}()};
+
+inline const bool queue_over_budget =
+	std::getenv("FAASHION_MEMORY_BUDGET_QUEUE") != nullptr;
+
+// a part of node_memory_budget, given back on destruction
+class budget_reservation {
+public:
+	explicit budget_reservation(std::uint64_t bytes) : bytes_(bytes) {}
+
+	budget_reservation(budget_reservation&& other) noexcept
+		: bytes_(std::exchange(other.bytes_, 0)) {}
+
+	budget_reservation& operator=(budget_reservation other) noexcept {
+		std::swap(bytes_, other.bytes_);
+		return *this;
+	}
+
+	~budget_reservation() {
+		if (bytes_) {
+			node_memory_budget.release(bytes_);
+		}
+	}
+
+private:
+	std::uint64_t bytes_;
+};
+
+inline std::optional<budget_reservation>
+try_reserve_memory(std::uint64_t bytes) {
+	if (!node_memory_budget.try_acquire(bytes)) {
+		return std::nullopt;
+	}
+	return budget_reservation{bytes};
+}
+
+// reserves bytes, calling wait between attempts if queueing is enabled.
+// refusals throw std::bad_alloc, which hpx rethrows as such on the locality
+// that invoked an action.
+inline budget_reservation reserve_memory(std::uint64_t bytes, auto wait) {
+	for (;;) {
+		if (auto reservation = try_reserve_memory(bytes)) {
+			return std::move(*reservation);
+		}
+		if (!queue_over_budget or bytes > node_memory_budget.total()) {
+			throw std::bad_alloc{};
+		}
+		wait();
+	}
+}
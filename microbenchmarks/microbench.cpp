@@ -1,7 +1,8 @@
 
 
-#include "wasmtime.hh"
+#include "wasm_functions.hpp"
 #include <benchmark/benchmark.h>
+#include <sys/resource.h>
 
 #include <algorithm>
 #include <chrono>
@@ -17,62 +18,29 @@
 #include <iostream>
 #include <memory>
 #include <numeric>
+#include <optional>
 #include <ranges>
 #include <span>
 #include <string>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "../functions_impl/mandelbrot.ipp"
 
 namespace {
-std::string get_file_contents(const char* filename) {
-	std::ifstream in(filename, std::ios::in);
-	if (!in) {
-		throw std::runtime_error{std::strerror(errno)};
-	}
-
-	in.seekg(0, std::ios::end);
-	std::string contents(in.tellg(), 0);
-	in.seekg(0);
-	in.read(contents.data(), std::ranges::ssize(contents));
-	return contents;
-}
-
-wasmtime::Engine global_wasmengine = wasmtime::Engine{};
-
-// stl containers are safe to read concurrently
-const std::unordered_map<std::string, wasmtime::Module> modules = [] {
-	std::unordered_map<std::string, wasmtime::Module> result;
-	for (const auto& entry : std::filesystem::directory_iterator{"functions"}) {
-		if (entry.is_regular_file() and entry.path().extension() == ".wat") {
-			result.emplace(
-				"/" + entry.path().stem().string(),
-				wasmtime::Module::compile(
-					global_wasmengine, get_file_contents(entry.path().c_str())
-				)
-					.unwrap()
-			);
-		}
-	}
-	return result;
-}();
-
-auto noop_mod = [] {
-	auto module_it = modules.find("/noop");
+function_module module_at(const std::string& path) {
+	auto module_it = modules.find(path);
 	if (module_it == modules.end()) {
 		throw std::runtime_error{"function not found"};
 	}
 	return module_it->second;
-}();
+}
 
-auto compute_mod = [] {
-	auto module_it = modules.find("/compute");
-	if (module_it == modules.end()) {
-		throw std::runtime_error{"function not found"};
-	}
-	return module_it->second;
-}();
+auto noop_mod = module_at("/noop");
+auto compute_mod = module_at("/compute");
+auto echo_mod = module_at("/echo");
+auto reverse_mod = module_at("/reverse");
 
 void thread_create_and_join(benchmark::State& state) {
 	for (auto _ : state) {
@@ -85,8 +53,7 @@ BENCHMARK(thread_create_and_join);
 void wasm_create_instance_and_store(benchmark::State& state) {
 	for (auto _ : state) {
 		wasmtime::Store wasmtime_store(global_wasmengine);
-		auto wasm_instance =
-			wasmtime::Instance::create(wasmtime_store, noop_mod, {}).unwrap();
+		auto wasm_instance = instantiate_function(wasmtime_store, noop_mod);
 	}
 }
 BENCHMARK(wasm_create_instance_and_store);
@@ -94,15 +61,10 @@ BENCHMARK(wasm_create_instance_and_store);
 void wasm_run_compute_complete(benchmark::State& state) {
 	for (auto _ : state) {
 		wasmtime::Store wasmtime_store(global_wasmengine);
-		auto wasm_instance =
-			wasmtime::Instance::create(wasmtime_store, compute_mod, {}).unwrap();
-
-		auto function = std::get<wasmtime::Func>(
-			*wasm_instance.get(wasmtime_store, "function")
-		);
+		auto wasm_instance = instantiate_function(wasmtime_store, compute_mod);
 
 		// execute wasm function
-		function.call(wasmtime_store, {0, 0}).unwrap();
+		wasm_instance.function.call(wasmtime_store, {0, 0}).unwrap();
 	}
 }
 BENCHMARK(wasm_run_compute_complete);
@@ -110,35 +72,224 @@ BENCHMARK(wasm_run_compute_complete);
 void wasm_run_noop_complete(benchmark::State& state) {
 	for (auto _ : state) {
 		wasmtime::Store wasmtime_store(global_wasmengine);
-		auto wasm_instance =
-			wasmtime::Instance::create(wasmtime_store, noop_mod, {}).unwrap();
-
-		auto function = std::get<wasmtime::Func>(
-			*wasm_instance.get(wasmtime_store, "function")
-		);
+		auto wasm_instance = instantiate_function(wasmtime_store, noop_mod);
 
 		// execute wasm function
-		function.call(wasmtime_store, {0, 0}).unwrap();
+		wasm_instance.function.call(wasmtime_store, {0, 0}).unwrap();
 	}
 }
 BENCHMARK(wasm_run_noop_complete);
 
 void wasm_run_noop_function_only(benchmark::State& state) {
 	wasmtime::Store wasmtime_store(global_wasmengine);
-	auto wasm_instance =
-		wasmtime::Instance::create(wasmtime_store, noop_mod, {}).unwrap();
-
-	auto function =
-		std::get<wasmtime::Func>(*wasm_instance.get(wasmtime_store, "function")
-	    );
+	auto wasm_instance = instantiate_function(wasmtime_store, noop_mod);
 
 	for (auto _ : state) {
 		// execute wasm function
-		function.call(wasmtime_store, {0, 0}).unwrap();
+		wasm_instance.function.call(wasmtime_store, {0, 0}).unwrap();
 	}
 }
 BENCHMARK(wasm_run_noop_function_only);
 
+// compiling a module is paid once per process, or once per profile with
+// FAASHION_MODULE_CACHE, but it is what fast-startup trades code quality for
+void wasm_compile_echo(benchmark::State& state) {
+	const auto text = get_file_contents("functions/echo.wat");
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(
+			wasmtime::Module::compile(global_wasmengine, text).unwrap()
+		);
+	}
+}
+BENCHMARK(wasm_compile_echo);
+
+// the phases of execute_function in bulk_http_hpx.cpp, one benchmark each. all
+// of them take the payload size as argument and report bytes per second, even
+// those whose cost does not depend on it, so the phases of a payload class can
+// be compared directly.
+const std::int64_t max_payload = 64 << 20;
+
+// an instance with its exports looked up, ready for the phases following
+// instantiation
+struct prepared_instance {
+	wasmtime::Store store{global_wasmengine};
+	function_instance instance;
+
+	explicit prepared_instance(const function_module& module)
+		: instance(instantiate_function(store, module)) {}
+
+	std::int32_t allocate(std::int64_t size) {
+		return instance.alloc.call(store, std::int32_t(size)).unwrap();
+	}
+};
+
+// minor page faults of this process so far. the phases that fault in fresh
+// memory report them per iteration, to compare runs with and without
+// FAASHION_HUGE_PAGES.
+long minor_faults() {
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_minflt;
+}
+
+void wasm_phase_store_create(benchmark::State& state) {
+	for (auto _ : state) {
+		wasmtime::Store wasmtime_store(global_wasmengine);
+		benchmark::DoNotOptimize(wasmtime_store);
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(wasm_phase_store_create)->Range(0, max_payload);
+
+void wasm_phase_instantiate(benchmark::State& state) {
+	for (auto _ : state) {
+		state.PauseTiming();
+		std::optional<wasmtime::Store> wasmtime_store(global_wasmengine);
+		state.ResumeTiming();
+
+		auto wasm_instance = instantiate(*wasmtime_store, echo_mod.module);
+		benchmark::DoNotOptimize(wasm_instance);
+
+		state.PauseTiming();
+		wasmtime_store.reset();
+		state.ResumeTiming();
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(wasm_phase_instantiate)->Range(0, max_payload);
+
+void wasm_phase_export_lookup(benchmark::State& state) {
+	wasmtime::Store wasmtime_store(global_wasmengine);
+	auto wasm_instance = instantiate(wasmtime_store, echo_mod.module);
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(
+			bind_exports(wasmtime_store, wasm_instance, echo_mod.exports)
+		);
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(wasm_phase_export_lookup)->Range(0, max_payload);
+
+// the first allocation in a fresh instance, like in execute_function. it
+// allocates the payload size instead of the fixed maximum execute_function
+// uses.
+void wasm_phase_alloc(benchmark::State& state) {
+	for (auto _ : state) {
+		state.PauseTiming();
+		std::optional<prepared_instance> prepared(echo_mod);
+		state.ResumeTiming();
+
+		benchmark::DoNotOptimize(prepared->allocate(state.range(0)));
+
+		state.PauseTiming();
+		prepared.reset();
+		state.ResumeTiming();
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(wasm_phase_alloc)->Range(0, max_payload);
+
+// copies into memory of a fresh instance, which includes faulting in its pages
+void wasm_phase_copy_in(benchmark::State& state) {
+	const std::vector<uint8_t> input(state.range(0), 'a');
+	long faults = 0;
+	for (auto _ : state) {
+		state.PauseTiming();
+		std::optional<prepared_instance> prepared(echo_mod);
+		const auto offset = prepared->allocate(state.range(0));
+		const auto faults_before = minor_faults();
+		state.ResumeTiming();
+
+		std::ranges::copy(
+			input,
+			prepared->instance.memory.data(prepared->store).begin() + offset
+		);
+
+		state.PauseTiming();
+		faults += minor_faults() - faults_before;
+		prepared.reset();
+		state.ResumeTiming();
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+	state.counters["page_faults"] =
+		benchmark::Counter(faults, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(wasm_phase_copy_in)->Range(0, max_payload);
+
+// the alternative to copy_in with FAASHION_MAP_INPUTS, maps the payload from a
+// memfd into memory of a fresh instance and touches every page of it
+void wasm_phase_map_in(benchmark::State& state) {
+	if (!map_inputs) {
+		state.SkipWithError("needs FAASHION_MAP_INPUTS");
+		return;
+	}
+	const std::size_t size = state.range(0);
+	memfd_buffer input(size);
+	std::ranges::fill(input.data(), 'a');
+	long faults = 0;
+	for (auto _ : state) {
+		state.PauseTiming();
+		std::optional<prepared_instance> prepared(echo_mod);
+		const auto offset = round_up_to_page(
+			prepared->allocate(round_up_to_page(size) + page_size)
+		);
+		const auto faults_before = minor_faults();
+		state.ResumeTiming();
+
+		auto memory = prepared->instance.memory.data(prepared->store);
+		map_into(memory, offset, input.fd(), size);
+		for (auto i = offset; i < offset + size; i += page_size) {
+			benchmark::DoNotOptimize(memory[i]);
+		}
+
+		state.PauseTiming();
+		faults += minor_faults() - faults_before;
+		prepared.reset();
+		state.ResumeTiming();
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+	state.counters["page_faults"] =
+		benchmark::Counter(faults, benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(wasm_phase_map_in)->Range(0, max_payload);
+
+void wasm_phase_call(benchmark::State& state, const function_module& module) {
+	prepared_instance prepared(module);
+	const auto offset = prepared.allocate(state.range(0));
+	for (auto _ : state) {
+		prepared.instance.function
+			.call(prepared.store, {offset, std::int32_t(state.range(0))})
+			.unwrap();
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_CAPTURE(wasm_phase_call, echo, echo_mod)->Range(0, max_payload);
+BENCHMARK_CAPTURE(wasm_phase_call, reverse, reverse_mod)
+	->Range(0, max_payload);
+
+void wasm_phase_get_output_size(benchmark::State& state) {
+	prepared_instance prepared(echo_mod);
+	for (auto _ : state) {
+		prepared.instance.get_output_size.call(prepared.store, {}).unwrap();
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(wasm_phase_get_output_size)->Range(0, max_payload);
+
+// copies the output into the vector execute_function returns
+void wasm_phase_copy_out(benchmark::State& state) {
+	prepared_instance prepared(echo_mod);
+	const auto offset = prepared.allocate(state.range(0));
+	for (auto _ : state) {
+		auto output = prepared.instance.memory.data(prepared.store)
+		                  .subspan(offset, state.range(0));
+		auto result = std::vector<uint8_t>(output.begin(), output.end());
+		benchmark::DoNotOptimize(result.data());
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(wasm_phase_copy_out)->Range(0, max_payload);
+
 
 void native_run_compute(benchmark::State& state) {
 	for (auto _ : state) {
@@ -148,4 +299,21 @@ void native_run_compute(benchmark::State& state) {
 }
 BENCHMARK(native_run_compute);
 
+// the scalar reference of the vectorized loop in native_run_compute
+void native_run_compute_scalar(benchmark::State& state) {
+	std::vector<unsigned char> iters(re_samples * im_samples);
+	for (auto _ : state) {
+		std::int64_t idx = 0;
+		for (auto im_idx = 0; im_idx < im_samples; ++im_idx) {
+			for (auto re_idx = 0; re_idx < re_samples; ++re_idx) {
+				iters[idx++] = iterations_to_diverge(
+					std::complex{re_at(re_idx), im_at(im_idx)}
+				);
+			}
+		}
+		benchmark::DoNotOptimize(iters.data());
+	}
+}
+BENCHMARK(native_run_compute_scalar);
+
 } // namespace
\ No newline at end of file
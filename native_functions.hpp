@@ -0,0 +1,115 @@
+
+// trusted native tier: functions_impl/*.cpp built as shared objects and loaded
+// with dlopen. they expose the same function/get_output_size/alloc/dealloc ABI
+// as the wasm modules but run unsandboxed, so only first-party functions
+// should be deployed this way. the tier is opt-in by pointing
+// FAASHION_NATIVE_FUNCTIONS at the directory containing the shared objects.
+#pragma once
+
+#include <dlfcn.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct native_function {
+	char* (*function)(char*, std::size_t);
+	std::size_t (*get_output_size)();
+	void* (*alloc)(std::size_t);
+	void (*dealloc)(void*);
+
+	static bool
+	within(std::span<const char> buffer, std::span<const char> part) {
+		return std::less_equal<>{}(buffer.data(), part.data()) and
+		       std::less_equal<>{}(
+				   part.data() + part.size(), buffer.data() + buffer.size()
+			   );
+	}
+
+	// the output of function is either placed inside the buffer it was given
+	// or in memory allocated by the function, which has to be released
+	void release(std::span<char> input, std::span<const char> output) const {
+		if (!output.empty() and !within(input, output)) {
+			dealloc(const_cast<char*>(output.data()));
+		}
+	}
+
+	// runs the function directly on the caller's buffer, no alloc and copy
+	// needed since the function shares our address space
+	template <typename Bytes>
+	Bytes operator()(Bytes input) const {
+		auto data =
+			std::span{reinterpret_cast<char*>(input.data()), input.size()};
+		const auto* offset = function(data.data(), data.size());
+		const auto output = std::span{offset, get_output_size()};
+
+		if (within(data, output)) {
+			std::memmove(data.data(), output.data(), output.size());
+			input.resize(output.size());
+		} else {
+			input.assign(output.begin(), output.end());
+			release(data, output);
+		}
+		return input;
+	}
+};
+
+inline void* open_native_library(const std::filesystem::path& path) {
+	// the libraries are never unloaded, they are used until exit
+	auto* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+	if (handle == nullptr) {
+		throw std::runtime_error{dlerror()};
+	}
+	return handle;
+}
+
+// loads every shared object in directory. streaming functions import their io
+// from the host and live in the streaming/ subdirectory instead, they are
+// loaded by the streaming runtime.
+inline std::unordered_map<std::string, native_function>
+load_native_functions(const std::filesystem::path& directory) {
+	std::unordered_map<std::string, native_function> result;
+	for (const auto& entry : std::filesystem::directory_iterator{directory}) {
+		if (!entry.is_regular_file() or entry.path().extension() != ".so") {
+			continue;
+		}
+		auto* handle = open_native_library(entry.path());
+
+		auto function = dlsym(handle, "function");
+		auto get_output_size = dlsym(handle, "get_output_size");
+		auto alloc = dlsym(handle, "alloc");
+		auto dealloc = dlsym(handle, "dealloc");
+		if (!function or !get_output_size or !alloc or !dealloc) {
+			std::cerr << "skipping " << entry.path()
+					  << ", does not export the function ABI\n";
+			continue;
+		}
+
+		result.emplace(
+			"/" + entry.path().stem().string(),
+			native_function{
+				reinterpret_cast<char* (*)(char*, std::size_t)>(function),
+				reinterpret_cast<std::size_t (*)()>(get_output_size),
+				reinterpret_cast<void* (*)(std::size_t)>(alloc),
+				reinterpret_cast<void (*)(void*)>(dealloc)}
+		);
+	}
+	return result;
+}
+
+// stl containers are safe to read concurrently
+inline const std::unordered_map<std::string, native_function>
+	native_functions = [] {
+		if (auto* directory = std::getenv("FAASHION_NATIVE_FUNCTIONS")) {
+			return load_native_functions(directory);
+		}
+		return std::unordered_map<std::string, native_function>{};
+	}();
@@ -0,0 +1,124 @@
+
+// numa placement for the servers, enabled with FAASHION_NUMA. connections are
+// handed to threads on the node of the cpu that received their packets, and
+// those threads only run on cpus of their node. buffers and linear memories are
+// then first touched, and so allocated, on the node that reads and executes a
+// request.
+#pragma once
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+inline const bool numa_placement = std::getenv("FAASHION_NUMA") != nullptr;
+
+struct numa_node {
+	int id;
+	// only those this process may run on
+	std::vector<int> cpus;
+};
+
+// parses a sysfs cpu list like 0-3,8-11
+inline std::vector<int> parse_cpu_list(const std::string& list) {
+	std::vector<int> cpus;
+	for (std::size_t begin = 0; begin < list.size();) {
+		auto end = list.find(',', begin);
+		if (end == std::string::npos) {
+			end = list.size();
+		}
+		const auto range = list.substr(begin, end - begin);
+		const auto dash = range.find('-');
+		const auto first = std::stoi(range.substr(0, dash));
+		const auto last = dash == std::string::npos
+		                      ? first
+		                      : std::stoi(range.substr(dash + 1));
+		for (auto cpu = first; cpu <= last; ++cpu) {
+			cpus.push_back(cpu);
+		}
+		begin = end + 1;
+	}
+	return cpus;
+}
+
+// the nodes with cpus in this process's affinity mask, a single node with all
+// of them if the kernel does not report any
+inline std::vector<numa_node> numa_nodes() {
+	cpu_set_t allowed;
+	CPU_ZERO(&allowed);
+	sched_getaffinity(0, sizeof(allowed), &allowed);
+
+	std::vector<numa_node> nodes;
+	const std::filesystem::path sysfs{"/sys/devices/system/node"};
+	std::error_code ec;
+	for (const auto& entry : std::filesystem::directory_iterator{sysfs, ec}) {
+		const auto name = entry.path().filename().string();
+		if (!name.starts_with("node") or
+		    name.find_first_not_of("0123456789", 4) != std::string::npos) {
+			continue;
+		}
+		std::ifstream in{entry.path() / "cpulist"};
+		std::string list;
+		std::getline(in, list);
+		numa_node node{std::stoi(name.substr(4)), {}};
+		for (auto cpu : parse_cpu_list(list)) {
+			if (CPU_ISSET(cpu, &allowed)) {
+				node.cpus.push_back(cpu);
+			}
+		}
+		if (!node.cpus.empty()) {
+			nodes.push_back(std::move(node));
+		}
+	}
+	if (nodes.empty()) {
+		numa_node node{0, {}};
+		for (auto cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+			if (CPU_ISSET(cpu, &allowed)) {
+				node.cpus.push_back(cpu);
+			}
+		}
+		nodes.push_back(std::move(node));
+	}
+	std::ranges::sort(nodes, {}, &numa_node::id);
+	return nodes;
+}
+
+// index into nodes of the node cpu belongs to, the first one if none does
+inline std::size_t
+node_of_cpu(const std::vector<numa_node>& nodes, std::optional<int> cpu) {
+	for (std::size_t idx = 0; cpu and idx < nodes.size(); ++idx) {
+		if (std::ranges::find(nodes[idx].cpus, *cpu) != nodes[idx].cpus.end()) {
+			return idx;
+		}
+	}
+	return 0;
+}
+
+// restricts the calling thread to cpus, the kernel balances it between them
+inline void pin_to_cpus(const std::vector<int>& cpus) {
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (auto cpu : cpus) {
+		CPU_SET(cpu, &set);
+	}
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+// the cpu that processed the packets of a connected socket, which follows the
+// receive queue of the nic that accepted the connection
+inline std::optional<int> incoming_cpu(int fd) {
+	int cpu;
+	socklen_t length = sizeof(cpu);
+	if (getsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &length) != 0 or
+	    cpu < 0) {
+		return std::nullopt;
+	}
+	return cpu;
+}
@@ -0,0 +1,24 @@
+
+// sizes given in environment variables, in bytes or with a K, M or G suffix
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+inline std::int64_t parse_size(std::string_view text) {
+	std::size_t end;
+	auto size = std::stoll(std::string{text}, &end);
+	const auto suffix = text.substr(end);
+	if (suffix == "K") {
+		size <<= 10;
+	} else if (suffix == "M") {
+		size <<= 20;
+	} else if (suffix == "G") {
+		size <<= 30;
+	} else if (!suffix.empty()) {
+		throw std::invalid_argument{"bad size " + std::string{text}};
+	}
+	return size;
+}
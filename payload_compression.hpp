@@ -0,0 +1,114 @@
+
+// lz4 compression of the bodies that actions carry between localities, for
+// links where bandwidth and not cpu bounds large payloads.
+// FAASHION_COMPRESS_PAYLOADS=threshold compresses bodies of at least threshold
+// bytes (K, M and G suffixes work) when they are serialized. bodies whose
+// first 64KB do not shrink by an eighth, like images or already compressed
+// data, are sent as they are without compressing the rest. whether a body was
+// compressed travels with it, so receivers decompress regardless of their own
+// setting.
+#pragma once
+
+#include "buffer_pool.hpp"
+#include "parse_size.hpp"
+
+#include <hpx/serialization.hpp>
+#include <lz4.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+inline const std::optional<std::size_t> compression_threshold =
+	[]() -> std::optional<std::size_t> {
+	if (const auto* threshold = std::getenv("FAASHION_COMPRESS_PAYLOADS")) {
+		return std::max<std::size_t>(parse_size(threshold), 1);
+	}
+	return std::nullopt;
+}();
+
+// what this process serialized as payloads, before and after compression
+struct payload_counters {
+	std::atomic<std::uint64_t> bytes = 0, wire_bytes = 0;
+};
+inline payload_counters sent_payloads;
+
+// a body passed to or returned from an action
+struct compressible_bytes {
+	pooled_bytes bytes;
+
+	static constexpr std::size_t probe_size = 64 << 10;
+
+	// worth compressing if a compressed prefix of it is smaller by an eighth
+	static bool compresses(std::span<const std::uint8_t> data) {
+		const auto probe = std::min(data.size(), probe_size);
+		pooled_bytes compressed(LZ4_compressBound(int(probe)));
+		const auto size = LZ4_compress_default(
+			reinterpret_cast<const char*>(data.data()),
+			reinterpret_cast<char*>(compressed.data()), int(probe),
+			int(compressed.size())
+		);
+		return size > 0 and std::size_t(size) < probe - probe / 8;
+	}
+
+	template <typename Archive>
+	void save(Archive& ar, unsigned) const {
+		const std::uint64_t size = bytes.size();
+		// 0 if the body is sent as it is
+		std::uint64_t compressed_size = 0;
+		pooled_bytes compressed;
+		if (compression_threshold and size >= *compression_threshold and
+		    size <= LZ4_MAX_INPUT_SIZE and compresses(bytes)) {
+			compressed.resize(LZ4_compressBound(int(size)));
+			const auto result = LZ4_compress_default(
+				reinterpret_cast<const char*>(bytes.data()),
+				reinterpret_cast<char*>(compressed.data()), int(size),
+				int(compressed.size())
+			);
+			if (result > 0 and std::uint64_t(result) < size) {
+				compressed_size = result;
+			}
+		}
+
+		ar << size << compressed_size;
+		if (compressed_size != 0) {
+			// copied into the archive, compressed does not outlive this call
+			ar.save_binary(compressed.data(), compressed_size);
+		} else if (size != 0) {
+			ar << hpx::serialization::make_array(bytes.data(), size);
+		}
+		sent_payloads.bytes += size;
+		sent_payloads.wire_bytes +=
+			compressed_size != 0 ? compressed_size : size;
+	}
+
+	template <typename Archive>
+	void load(Archive& ar, unsigned) {
+		std::uint64_t size, compressed_size;
+		ar >> size >> compressed_size;
+		// not zeroed, see pooled_allocator
+		bytes.resize(size);
+		if (compressed_size == 0) {
+			if (size != 0) {
+				ar >> hpx::serialization::make_array(bytes.data(), size);
+			}
+			return;
+		}
+		pooled_bytes compressed(compressed_size);
+		ar.load_binary(compressed.data(), compressed_size);
+		if (LZ4_decompress_safe(
+				reinterpret_cast<const char*>(compressed.data()),
+				reinterpret_cast<char*>(bytes.data()), int(compressed_size),
+				int(size)
+			) != int(size)) {
+			throw std::runtime_error{"corrupt compressed payload"};
+		}
+	}
+
+	HPX_SERIALIZATION_SPLIT_MEMBER()
+};
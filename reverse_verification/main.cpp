@@ -1,9 +1,72 @@
 #include <algorithm>
 #include <boost/iostreams/device/mapped_file.hpp>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <span>
+#include <string_view>
 
+#include "../functions_impl/reverse.ipp"
+
+namespace {
+// writes every page once, so the copy on write faults of a private mapping are
+// not part of the measured time
+void prefault(std::span<char> data) {
+	for (std::size_t i = 0; i < data.size(); i += 4096) {
+		static_cast<volatile char&>(data[i]) = data[i];
+	}
+}
+
+// reverses a private copy of the file and prints the throughput in GB/s
+void timed_reverse(
+	const char* name, std::span<char> data, auto reverse_function
+) {
+	prefault(data);
+	const auto start = std::chrono::steady_clock::now();
+	reverse_function(data);
+	const std::chrono::duration<double> duration =
+		std::chrono::steady_clock::now() - start;
+	std::cerr << name << ": " << data.size() / duration.count() / 1e9
+			  << " GB/s\n";
+}
+
+// reverses the file with std::ranges::reverse and with reverse_bytes, the
+// results have to be identical. the file itself is not modified.
+int verify(const char* path) {
+	boost::iostreams::mapped_file scalar(
+		path, boost::iostreams::mapped_file::priv
+	);
+	boost::iostreams::mapped_file vectorized(
+		path, boost::iostreams::mapped_file::priv
+	);
+	if (!scalar.is_open() or !vectorized.is_open()) {
+		std::cerr << "Error opening file: " << path << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	auto expected = std::span<char>{scalar.data(), scalar.size()};
+	auto actual = std::span<char>{vectorized.data(), vectorized.size()};
+	timed_reverse("scalar", expected, [](auto r) { std::ranges::reverse(r); });
+	timed_reverse("vectorized", actual, reverse_bytes);
+
+	if (std::memcmp(expected.data(), actual.data(), actual.size()) != 0) {
+		std::cerr << "vectorized reverse differs from the scalar reverse\n";
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
+} // namespace
+
+// usage: main FILE reverses FILE in place, main --verify FILE compares the
+// vectorized reverse against the scalar one without modifying FILE
 int main(int argc, char* argv[]) {
+	if (argc == 3 and std::string_view{argv[1]} == "--verify") {
+		return verify(argv[2]);
+	}
+
 	std::cerr << argv[1];
 	boost::iostreams::mapped_file file(
 		argv[1], boost::iostreams::mapped_file::readwrite
@@ -17,6 +80,5 @@ int main(int argc, char* argv[]) {
 	char* p = file.data();
 	assert(p);
 
-	auto r = std::span<char>{p, file.size()};
-	std::ranges::reverse(r);
+	reverse_bytes(std::span<char>{p, file.size()});
 }
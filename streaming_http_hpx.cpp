@@ -11,6 +11,10 @@
 #include <boost/beast/http.hpp>
 #include <boost/beast/version.hpp>
 
+#include "h2c.hpp"
+#include "native_functions.hpp"
+#include "wasm_functions.hpp"
+
 #include <hpx/hpx_start.hpp>
 #include <hpx/include/actions.hpp>
 #include <hpx/include/lcos.hpp>
@@ -23,6 +27,7 @@
 #include <chrono>
 #include <cstdlib>
 #include <ctime>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <memory>
@@ -30,6 +35,7 @@
 #include <ranges>
 #include <span>
 #include <string>
+#include <unordered_map>
 
 namespace beast = boost::beast;   // from <boost/beast.hpp>
 namespace http = beast::http;     // from <boost/beast/http.hpp>
@@ -49,49 +55,304 @@ auto std2boost(std::span<T, E> s) {
 	return boost::span<T, E>{s.data(), s.size()};
 }
 
-std::string get_file_contents(const char* filename) {
-	std::ifstream in(filename, std::ios::in);
-	if (!in) {
-		throw std::runtime_error{std::strerror(errno)};
+HPX_REGISTER_CHANNEL(uint8_t)
+
+// io of a function invocation, which streaming functions import from the host
+struct function_io {
+	hpx::lcos::channel<uint8_t> input;
+	hpx::lcos::send_channel<uint8_t> output;
+	decltype(input.begin()) input_it = input.begin();
+	decltype(input.end()) input_end = input.end();
+
+	int32_t more() {
+		auto result = input_it != input_end;
+		return result;
 	}
+	void put_byte(uint32_t byte) { output.set(byte); }
+	int32_t get_byte() {
+		if (input_it != input_end) {
+			return *input_it++;
+		}
+		return 0;
+	}
+};
 
-	in.seekg(0, std::ios::end);
-	std::string contents(in.tellg(), 0);
-	in.seekg(0);
-	in.read(contents.data(), std::ranges::ssize(contents));
-	return contents;
+// native streaming functions resolve their imports against the executable. the
+// invocation they belong to is kept in the hpx thread's data, the thread may be
+// resumed on another worker whenever a channel suspends it.
+function_io& current_io() {
+	return *reinterpret_cast<function_io*>(
+		hpx::threads::get_thread_data(hpx::threads::get_self_id())
+	);
 }
 
-HPX_REGISTER_CHANNEL(uint8_t)
+extern "C" uint8_t get_byte() { return current_io().get_byte(); }
+extern "C" uint8_t more() { return current_io().more(); }
+extern "C" void put_byte(uint8_t byte) { current_io().put_byte(byte); }
+
+// streaming functions of the trusted native tier, see native_functions.hpp
+const std::unordered_map<std::string, void (*)()> native_streaming_functions =
+	[] {
+		std::unordered_map<std::string, void (*)()> result;
+		auto* directory = std::getenv("FAASHION_NATIVE_FUNCTIONS");
+		if (!directory or
+		    !std::filesystem::is_directory(
+				std::filesystem::path{directory} / "streaming"
+			)) {
+			return result;
+		}
+		for (const auto& entry : std::filesystem::directory_iterator{
+				 std::filesystem::path{directory} / "streaming"}) {
+			if (entry.is_regular_file() and entry.path().extension() == ".so") {
+				result.emplace(
+					"/" + entry.path().stem().string(),
+					reinterpret_cast<void (*)()>(dlsym(
+						open_native_library(entry.path()), "function"
+					))
+				);
+			}
+		}
+		return result;
+	}();
+
+// wasm streaming functions import the same io as native ones, see
+// functions_impl/streaming.cpp. they follow the ABI of binaryen's asyncify (see
+// functions/streaming/streaming.wat), so a guest waiting for input can unwind
+// its stack into its linear memory and return to the host. the host waits for
+// the input on the channel's future, which suspends the hpx thread and frees
+// its worker, and then calls the guest again to rewind it to where it left off.
+// wasmtime keeps the state of running guests per os thread, so the hpx thread
+// must not be suspended while guest frames are on it, it may be resumed on
+// another worker.
+class wasm_function_io {
+public:
+	// bytes of guest stack that can be unwound
+	static constexpr std::int32_t stack_size = 16 << 10;
+
+	wasm_function_io(
+		hpx::lcos::channel<uint8_t> input,
+		hpx::lcos::send_channel<uint8_t> output
+	)
+		: input_(std::move(input)), output_(std::move(output)) {}
+
+	// binds the exports of an instance and allocates the buffer its stack is
+	// unwound into
+	void bind(wasmtime::Store& store, wasmtime::Instance instance) {
+		auto func = [&](std::string_view name) {
+			auto item = instance.get(store, name);
+			if (!item or !std::holds_alternative<wasmtime::Func>(*item)) {
+				throw std::runtime_error{
+					"module does not export " + std::string{name}};
+			}
+			return std::get<wasmtime::Func>(*item);
+		};
+		function_ = func("function");
+		start_unwind_ = func("asyncify_start_unwind");
+		stop_unwind_ = func("asyncify_stop_unwind");
+		start_rewind_ = func("asyncify_start_rewind");
+		stop_rewind_ = func("asyncify_stop_rewind");
+
+		data_ = func("alloc")
+		            .call(store, {std::int32_t(8 + stack_size)})
+		            .unwrap()[0]
+		            .i32();
+		if (data_ == 0) {
+			throw std::bad_alloc{};
+		}
+		// asyncify's data: where the unwound stack continues and ends
+		const std::int32_t bounds[] = {data_ + 8, data_ + 8 + stack_size};
+		auto memory = instance.get(store, "memory");
+		std::memcpy(
+			std::get<wasmtime::Memory>(*memory).data(store).data() + data_,
+			bounds, sizeof(bounds)
+		);
+	}
+
+	int32_t more(wasmtime::Caller caller) {
+		if (!input_ready(caller)) {
+			return 0;
+		}
+		return !next_->has_exception();
+	}
+	int32_t get_byte(wasmtime::Caller caller) {
+		if (!input_ready(caller) or next_->has_exception()) {
+			return 0;
+		}
+		auto byte = next_->get();
+		next_.reset();
+		return byte;
+	}
+	// sending does not wait for the receiver
+	void put_byte(int32_t byte) { output_.set(uint8_t(byte)); }
+
+	// calls the guest's function until it returns without having unwound
+	void run(wasmtime::Store& store) {
+		for (;;) {
+			auto result = function_->call(store, {});
+			if (!result) {
+				throw std::runtime_error{result.err().message()};
+			}
+			if (!unwound_) {
+				return;
+			}
+			stop_unwind_->call(store, {}).unwrap();
+			unwound_ = false;
+			// no guest frames are left on this thread
+			next_->wait();
+			start_rewind_->call(store, {data_}).unwrap();
+			rewinding_ = true;
+		}
+	}
+
+private:
+	hpx::lcos::channel<uint8_t> input_;
+	hpx::lcos::send_channel<uint8_t> output_;
+	// the next input byte, the channel's future throws once it is closed
+	std::optional<hpx::future<uint8_t>> next_;
+
+	std::optional<wasmtime::Func> function_, start_unwind_, stop_unwind_,
+		start_rewind_, stop_rewind_;
+	std::int32_t data_ = 0;
+	bool unwound_ = false, rewinding_ = false;
+
+	// whether the next input byte is there, otherwise the guest is unwound.
+	// a rewound guest calls the import that unwound it again, the byte it
+	// waited for is there then.
+	bool input_ready(wasmtime::Caller caller) {
+		if (rewinding_) {
+			stop_rewind_->call(caller.context(), {}).unwrap();
+			rewinding_ = false;
+		}
+		if (!next_) {
+			next_ = input_.get();
+		}
+		if (next_->is_ready()) {
+			return true;
+		}
+		start_unwind_->call(caller.context(), {data_}).unwrap();
+		unwound_ = true;
+		return false;
+	}
+};
+
+wasmtime::Instance instantiate_streaming(
+	wasmtime::Store& store, const wasmtime::Module& module,
+	wasm_function_io& io
+) {
+	std::vector<wasmtime::Extern> imports;
+	for (auto import : module.imports()) {
+		const auto name = import.name();
+		if (import.module() != "env") {
+			throw std::runtime_error{"unknown import " + std::string{name}};
+		}
+		if (name == "more") {
+			imports.emplace_back(wasmtime::Func::wrap(
+				store,
+				[&io](wasmtime::Caller caller) { return io.more(caller); }
+			));
+		} else if (name == "get_byte") {
+			imports.emplace_back(wasmtime::Func::wrap(
+				store,
+				[&io](wasmtime::Caller caller) { return io.get_byte(caller); }
+			));
+		} else if (name == "put_byte") {
+			imports.emplace_back(wasmtime::Func::wrap(
+				store, [&io](int32_t byte) { io.put_byte(byte); }
+			));
+		} else if (name == "emscripten_notify_memory_growth") {
+			imports.emplace_back(memory_growth_notification(store));
+		} else {
+			throw std::runtime_error{"unknown import " + std::string{name}};
+		}
+	}
+
+	auto created = wasmtime::Instance::create(store, module, imports);
+	if (!created) {
+		throw std::runtime_error{created.err().message()};
+	}
+	auto instance = created.ok();
+	if (auto initialize = instance.get(store, "_initialize")) {
+		std::get<wasmtime::Func>(*initialize).call(store, {}).unwrap();
+	}
+	return instance;
+}
+
+struct streaming_module {
+	wasmtime::Module module;
+	function_limits limits;
+};
+
+const std::unordered_map<std::string, streaming_module> streaming_modules =
+	[] {
+		std::unordered_map<std::string, streaming_module> result;
+		if (!std::filesystem::is_directory("functions/streaming")) {
+			return result;
+		}
+		for (const auto& entry :
+		     std::filesystem::directory_iterator{"functions/streaming"}) {
+			if (entry.is_regular_file() and
+			    entry.path().extension() == ".wat") {
+				auto path = "/" + entry.path().stem().string();
+				auto limits = limits_of(path);
+				result.emplace(
+					std::move(path),
+					streaming_module{compile_module(entry.path()), limits}
+				);
+			}
+		}
+		return result;
+	}();
+
+void execute_wasm(
+	const streaming_module& module, hpx::lcos::channel<uint8_t> input,
+	hpx::lcos::send_channel<uint8_t> output
+) {
+	wasmtime::Store store{global_wasmengine};
+	apply_limits(store, module.limits);
+	wasm_function_io io{std::move(input), std::move(output)};
+	io.bind(store, instantiate_streaming(store, module.module, io));
+	io.run(store);
+}
 
 void execute_function(
 	std::string function_path, hpx::lcos::channel<uint8_t> input,
 	hpx::lcos::send_channel<uint8_t> output
 ) {
 	// hpx::cout << "hello from " << hpx::get_locality_id() << std::endl;
-	auto input_it = input.begin();
-	auto input_end = input.end();
+	if (auto native_it = native_streaming_functions.find(function_path);
+	    native_it != native_streaming_functions.end()) {
+		function_io io{input, output};
+		hpx::threads::set_thread_data(
+			hpx::threads::get_self_id(), reinterpret_cast<std::size_t>(&io)
+		);
+		native_it->second();
+		output.close();
+		return;
+	}
 
-	auto more = [&] -> int32_t {
-		auto result = input_it != input_end;
-		return result;
-	};
-	auto put_byte = [&](uint32_t byte) { output.set(byte); };
-	auto get_byte = [&] -> int32_t {
-		if (input_it != input_end) {
-			return *input_it++;
+	if (auto wasm_it = streaming_modules.find(function_path);
+	    wasm_it != streaming_modules.end()) {
+		try {
+			execute_wasm(wasm_it->second, input, output);
+		} catch (...) {
+			output.close();
+			throw;
 		}
-		return 0;
-	};
+		output.close();
+		return;
+	}
+
+	// function_io's iterators wait for the first byte already
+	function_io io{input, output};
 
 	/////"wasm" function dispatch//
 	if (function_path == "/echo") {
-		while (more()) {
-			put_byte(get_byte());
+		while (io.more()) {
+			io.put_byte(io.get_byte());
 		}
 	} else if (function_path == "/noop") {
-		while (more()) {
-			get_byte();
+		while (io.more()) {
+			io.get_byte();
 		}
 	} else {
 		output.close();
@@ -327,6 +588,71 @@ void http_server(tcp::acceptor& acceptor, tcp::socket& socket) {
 	});
 }
 
+// serves the streams of h2c connections. the request's DATA frames are put
+// into the input channel as they arrive, the output is sent in DATA frames of
+// up to a write buffer's size as the function produces it.
+void serve_h2c_stream(std::shared_ptr<h2c_stream> stream) {
+	if (stream->method != "POST") {
+		stream->respond(400, "Invalid request-method.");
+		return;
+	}
+
+	hpx::lcos::channel<uint8_t> input{hpx::find_here()},
+		output{hpx::find_here()};
+	// frames are put into the channel on hpx threads, one after the other.
+	// the client may only send more once a frame is in the channel, so a slow
+	// function holds at most a stream window of frames here.
+	auto forwarded =
+		std::make_shared<hpx::future<void>>(hpx::make_ready_future());
+	stream->on_data = [stream, input,
+	                   forwarded](std::span<const uint8_t> data) {
+		*forwarded = forwarded->then(
+			[stream, input,
+		     bytes = std::vector<uint8_t>(data.begin(), data.end())](
+				hpx::future<void>
+			) mutable {
+				for (auto byte : bytes) {
+					input.set(byte);
+				}
+				stream->consume(bytes.size());
+			}
+		);
+	};
+	stream->on_end = [input, forwarded] {
+		*forwarded = forwarded->then([input](hpx::future<void>) mutable {
+			// indicate that this is all the input
+			input.close();
+		});
+	};
+
+	stream->start_response(200, "application/octet-stream");
+	hpx::post([stream, output]() mutable {
+		pooled_bytes part;
+		// this "blocks" until the worker has given us enough output to fill
+		// a frame
+		for (auto byte : output) {
+			part.push_back(byte);
+			if (part.size() == 1024) {
+				stream->write(std::move(part));
+				part.clear();
+			}
+		}
+		stream->write(std::move(part));
+		stream->finish();
+	});
+
+	hpx::post([stream, input, output] {
+		execute_function_action f;
+		try {
+			f(get_round_robin_locality(), stream->path, input, output);
+		} catch (const std::exception& e) {
+			std::cerr << "action threw: " << e.what() << '\n';
+			// the response has been started already
+			stream->reset();
+		}
+	});
+}
+
 int main(int argc, char* argv[]) {
 	try {
 		// Initialize HPX, don't run hpx_main
@@ -346,6 +672,14 @@ int main(int argc, char* argv[]) {
 			tcp::socket socket{ioc};
 			http_server(acceptor, socket);
 
+			std::optional<tcp::acceptor> h2c_acceptor;
+			std::optional<tcp::socket> h2c_socket;
+			if (h2c_port) {
+				h2c_acceptor.emplace(ioc, tcp::endpoint{address, *h2c_port});
+				h2c_socket.emplace(ioc);
+				h2c_server(*h2c_acceptor, *h2c_socket, serve_h2c_stream);
+			}
+
 			ioc.run();
 
 			// this shutdown is not clean at all, but it does not matter for our
@@ -0,0 +1,388 @@
+
+// module loading and instantiation shared by all runtimes that execute wasm
+// functions
+#pragma once
+
+#include "memfd_memory.hpp"
+#include "memory_limits.hpp"
+#include "wasmtime.hh"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+inline std::string get_file_contents(const char* filename) {
+	std::ifstream in(filename, std::ios::in);
+	if (!in) {
+		throw std::runtime_error{std::strerror(errno)};
+	}
+
+	in.seekg(0, std::ios::end);
+	std::string contents(in.tellg(), 0);
+	in.seekg(0);
+	in.read(contents.data(), std::ranges::ssize(contents));
+	return contents;
+}
+
+// engine configurations, one is chosen with FAASHION_ENGINE_PROFILE:
+// - throughput (default): optimized code and memories that are always static
+//   with a 4GB reservation and 2GB of guard pages. every access of a wasm32
+//   module stays inside them, so compiled code has no bounds checks. these are
+//   wasmtime's own defaults on 64 bit hosts, the profile only spells them out
+//   as the baseline the others deviate from.
+// - density: static reservations just as large as the 2GB memories of our
+//   modules and small guards. an instance reserves about 2GB of address space
+//   instead of 6GB, for many more instances in flight, but accesses are bounds
+//   checked.
+// - fast-startup: memories like throughput, but cranelift does not optimize,
+//   which makes compiling modules much faster.
+inline const std::string engine_profile = [] {
+	const auto* profile = std::getenv("FAASHION_ENGINE_PROFILE");
+	return std::string{profile ? profile : "throughput"};
+}();
+
+inline wasmtime::Config engine_config(std::string_view profile) {
+	constexpr std::size_t GiB = std::size_t(1) << 30;
+	wasmtime::Config config;
+	wasmtime_config_parallel_compilation_set(config.capi(), true);
+	if (profile == "throughput") {
+		config.cranelift_opt_level(wasmtime::OptLevel::Speed);
+		config.static_memory_maximum_size(4 * GiB);
+		config.static_memory_guard_size(2 * GiB);
+	} else if (profile == "density") {
+		config.cranelift_opt_level(wasmtime::OptLevel::Speed);
+		config.static_memory_maximum_size(2 * GiB);
+		config.static_memory_guard_size(64 << 10);
+		config.dynamic_memory_guard_size(64 << 10);
+	} else if (profile == "fast-startup") {
+		config.cranelift_opt_level(wasmtime::OptLevel::None);
+		config.static_memory_maximum_size(4 * GiB);
+		config.static_memory_guard_size(2 * GiB);
+	} else {
+		throw std::invalid_argument{
+			"unknown engine profile " + std::string{profile}};
+	}
+	// memfd memories are advised to use huge pages as well
+	if (map_inputs) {
+		use_memfd_memories(config);
+	} else if (huge_pages) {
+		use_huge_page_memories(config);
+	}
+	return config;
+}
+
+// An engine is safe to share between threads. Multiple stores can be created
+// within the same engine with each store living on a separate thread. Typically
+// you'll create one
+// [wasm_engine_t](https://docs.wasmtime.dev/c-api/structwasm__engine__t.html
+// "Compilation environment and configuration.") for the lifetime of your
+// program.
+inline wasmtime::Engine global_wasmengine =
+	wasmtime::Engine{engine_config(engine_profile)};
+
+// positions of the function ABI's exports. instances list their exports in the
+// order of their module, so the positions are resolved once per module and
+// looked up by index instead of by name on every request.
+struct function_exports {
+	std::size_t memory, alloc, function, get_output_size;
+	// only needed by runtimes that reuse instances
+	std::optional<std::size_t> dealloc;
+};
+
+inline function_exports resolve_exports(const wasmtime::Module& module) {
+	const auto exports = module.exports();
+	std::unordered_map<std::string_view, std::size_t> positions;
+	for (auto export_type : exports) {
+		positions.emplace(export_type.name(), positions.size());
+	}
+	auto position = [&](std::string_view name) {
+		auto it = positions.find(name);
+		if (it == positions.end()) {
+			throw std::runtime_error{
+				"module does not export " + std::string{name}};
+		}
+		return it->second;
+	};
+	std::optional<std::size_t> dealloc;
+	if (auto it = positions.find("dealloc"); it != positions.end()) {
+		dealloc = it->second;
+	}
+	return {
+		position("memory"), position("alloc"), position("function"),
+		position("get_output_size"), dealloc};
+}
+
+struct function_module {
+	wasmtime::Module module;
+	function_exports exports;
+	function_limits limits;
+};
+
+// compiled modules are kept in the directory FAASHION_MODULE_CACHE if it is
+// set, under the engine profile and a hash of their text. wasmtime refuses
+// modules compiled with another configuration, so every profile has its own.
+inline wasmtime::Module compile_module(const std::filesystem::path& path) {
+	const auto text = get_file_contents(path.c_str());
+	const auto* cache = std::getenv("FAASHION_MODULE_CACHE");
+	if (!cache) {
+		return wasmtime::Module::compile(global_wasmengine, text).unwrap();
+	}
+
+	std::uint64_t hash = 14695981039346656037u;
+	for (auto c : text) {
+		hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211u;
+	}
+	const auto directory = std::filesystem::path{cache} / engine_profile;
+	const auto cached =
+		directory /
+		(path.stem().string() + '-' + std::to_string(hash) + ".cwasm");
+	if (std::filesystem::exists(cached)) {
+		// entries of another wasmtime version are recompiled
+		auto module = wasmtime::Module::deserialize_file(
+			global_wasmengine, cached.string()
+		);
+		if (module) {
+			return module.ok();
+		}
+	}
+
+	auto module = wasmtime::Module::compile(global_wasmengine, text).unwrap();
+	// written under a temporary name, other processes may read the cache
+	std::filesystem::create_directories(directory);
+	const auto temporary =
+		cached.string() + '.' + std::to_string(getpid()) + ".tmp";
+	const auto serialized = module.serialize().unwrap();
+	std::ofstream{temporary, std::ios::binary}.write(
+		reinterpret_cast<const char*>(serialized.data()),
+		std::ssize(serialized)
+	);
+	std::filesystem::rename(temporary, cached);
+	return module;
+}
+
+// stl containers are safe to read concurrently
+inline const std::unordered_map<std::string, function_module> modules = [] {
+	std::unordered_map<std::string, function_module> result;
+	for (const auto& entry : std::filesystem::directory_iterator{"functions"}) {
+		if (entry.is_regular_file() and entry.path().extension() == ".wat") {
+			auto module = compile_module(entry.path());
+			auto exports = resolve_exports(module);
+			auto path = "/" + entry.path().stem().string();
+			auto limits = limits_of(path);
+			result.emplace(
+				std::move(path),
+				function_module{std::move(module), exports, limits}
+			);
+		}
+	}
+	return result;
+}();
+
+// whether size bytes at offset lie inside memory. offsets and sizes that
+// guests hand to the host are checked with it before the host touches them.
+inline bool within_memory(
+	std::span<const std::uint8_t> memory, std::int64_t offset,
+	std::int64_t size
+) {
+	return offset >= 0 and size >= 0 and
+	       std::uint64_t(offset) + std::uint64_t(size) <= memory.size();
+}
+
+// arguments of the parallel_for import, see functions_impl/parallel_for.hpp.
+// body is an index into the module's function table.
+struct parallel_for_args {
+	std::int32_t begin, end, body, input, input_size, output, stride;
+};
+
+using parallel_for_t =
+	std::function<wasmtime::Result<std::monostate, wasmtime::Trap>(
+		wasmtime::Caller, const parallel_for_args&
+	)>;
+
+// whether the input and the (end - begin) * stride bytes of output of a
+// parallel_for lie inside the caller's memory. the host reads and writes them
+// on the guest's behalf, so they are checked before any iteration runs.
+inline bool parallel_for_in_bounds(
+	std::span<const std::uint8_t> memory, const parallel_for_args& args
+) {
+	const auto iterations =
+		std::max<std::int64_t>(0, std::int64_t(args.end) - args.begin);
+	return args.stride >= 0 and
+	       within_memory(memory, args.input, args.input_size) and
+	       within_memory(memory, args.output, iterations * args.stride);
+}
+
+// the function at idx of the __indirect_function_table export, if there is
+// one
+inline std::optional<wasmtime::Func> parallel_for_body(
+	wasmtime::Store::Context cx, std::optional<wasmtime::Extern> table,
+	int32_t idx
+) {
+	auto* functions = table ? std::get_if<wasmtime::Table>(&*table) : nullptr;
+	if (!functions) {
+		return std::nullopt;
+	}
+	auto element = functions->get(cx, std::uint32_t(idx));
+	if (!element) {
+		return std::nullopt;
+	}
+	return element->funcref();
+}
+
+// the data of the caller's memory export, empty if it has none
+inline std::span<std::uint8_t> caller_memory(wasmtime::Caller& caller) {
+	auto memory = caller.get_export("memory");
+	auto* data = memory ? std::get_if<wasmtime::Memory>(&*memory) : nullptr;
+	return data ? data->data(caller.context()) : std::span<std::uint8_t>{};
+}
+
+// runs all iterations in the calling instance, for runtimes without a thread
+// pool and nested parallel_for calls
+inline wasmtime::Result<std::monostate, wasmtime::Trap>
+parallel_for_serial(wasmtime::Caller caller, const parallel_for_args& args) {
+	auto body = parallel_for_body(
+		caller.context(), caller.get_export("__indirect_function_table"),
+		args.body
+	);
+	if (!body) {
+		return wasmtime::Trap{"parallel_for body is not a function"};
+	}
+	if (!parallel_for_in_bounds(caller_memory(caller), args)) {
+		return wasmtime::Trap{"parallel_for arguments exceed the memory"};
+	}
+	for (std::int64_t i = args.begin; i < args.end; ++i) {
+		// in bounds, so the offset fits the i32 the guest sees
+		auto result = body->call(
+			caller.context(),
+			{std::int32_t(i), args.input, args.input_size,
+		     std::int32_t(args.output + (i - args.begin) * args.stride)}
+		);
+		if (!result) {
+			return wasmtime::Trap{result.err().message()};
+		}
+	}
+	return std::monostate{};
+}
+
+// standalone Emscripten modules with growable memories call this import after
+// growing their memory. the host looks the memory up after every call into the
+// guest, so there is nothing to update.
+inline wasmtime::Func memory_growth_notification(wasmtime::Store& store) {
+	return wasmtime::Func::wrap(store, [](int32_t /*memory*/) {});
+}
+
+// Emscripten reactors export _initialize, which runs the static constructors
+// and has to be called before any other export. Modules built with
+// `make -C functions_impl` are snapshotted with wizer after their
+// initialization, which bakes the resulting memory and globals into the module
+// and removes the export, so the initialization is paid once per deployment
+// instead of once per request.
+inline wasmtime::Instance instantiate(
+	wasmtime::Store& store, const wasmtime::Module& module,
+	parallel_for_t parallel_for = parallel_for_serial
+) {
+	std::vector<wasmtime::Extern> imports;
+	for (auto import : module.imports()) {
+		const auto name = import.name();
+		if (import.module() != "env") {
+			throw std::runtime_error{"unknown import " + std::string{name}};
+		}
+		if (name == "parallel_for") {
+			imports.emplace_back(wasmtime::Func::wrap(
+				store,
+				[parallel_for](
+					wasmtime::Caller caller, int32_t begin, int32_t end,
+					int32_t body, int32_t input, int32_t input_size,
+					int32_t output, int32_t stride
+				) {
+					return parallel_for(
+						caller,
+						{begin, end, body, input, input_size, output, stride}
+					);
+				}
+			));
+		} else if (name == "emscripten_notify_memory_growth") {
+			imports.emplace_back(memory_growth_notification(store));
+		} else {
+			throw std::runtime_error{"unknown import " + std::string{name}};
+		}
+	}
+
+	auto created = wasmtime::Instance::create(store, module, imports);
+	// fails if the store's limits are below the module's memory or table
+	if (!created) {
+		throw std::runtime_error{created.err().message()};
+	}
+	auto instance = created.ok();
+	if (auto initialize = instance.get(store, "_initialize")) {
+		std::get<wasmtime::Func>(*initialize).call(store, {}).unwrap();
+	}
+	return instance;
+}
+
+// an instance of a function module with typed handles to the function ABI.
+// typed calls pass their arguments and results without vectors of Val.
+struct function_instance {
+	wasmtime::Instance instance;
+	wasmtime::Memory memory;
+	wasmtime::TypedFunc<std::int32_t, std::int32_t> alloc;
+	wasmtime::TypedFunc<std::tuple<std::int32_t, std::int32_t>, std::int32_t>
+		function;
+	wasmtime::TypedFunc<std::tuple<>, std::int32_t> get_output_size;
+	std::optional<wasmtime::TypedFunc<std::int32_t, std::tuple<>>> dealloc;
+};
+
+inline function_instance bind_exports(
+	wasmtime::Store& store, wasmtime::Instance instance,
+	const function_exports& exports
+) {
+	auto get = [&](std::size_t idx) {
+		return instance.get(store, idx)->second;
+	};
+	auto func = [&](std::size_t idx) {
+		return std::get<wasmtime::Func>(get(idx));
+	};
+	std::optional<wasmtime::TypedFunc<std::int32_t, std::tuple<>>> dealloc;
+	if (exports.dealloc) {
+		dealloc = func(*exports.dealloc)
+		              .typed<std::int32_t, std::tuple<>>(store)
+		              .unwrap();
+	}
+	return {
+		instance, std::get<wasmtime::Memory>(get(exports.memory)),
+		func(exports.alloc).typed<std::int32_t, std::int32_t>(store).unwrap(),
+		func(exports.function)
+			.typed<std::tuple<std::int32_t, std::int32_t>, std::int32_t>(store)
+			.unwrap(),
+		func(exports.get_output_size)
+			.typed<std::tuple<>, std::int32_t>(store)
+			.unwrap(),
+		dealloc};
+}
+
+inline function_instance instantiate_function(
+	wasmtime::Store& store, const function_module& module,
+	parallel_for_t parallel_for = parallel_for_serial
+) {
+	return bind_exports(
+		store, instantiate(store, module.module, std::move(parallel_for)),
+		module.exports
+	);
+}